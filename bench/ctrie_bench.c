@@ -0,0 +1,190 @@
+#include "concurrent_trie.h"
+#include "trie.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/* The number of distinct words and the total number of insertions of every run */
+#define WORDS 50000
+#define INSERTIONS 4000000
+
+#define MAX_THREADS 8
+
+/* A producer inserting the words [begin, end) */
+struct producer {
+    struct ctrie *trie;
+    size_t begin, end;
+    bool ok;
+};
+
+/* The words inserted by every run, generated once */
+static char words[INSERTIONS][8];
+static size_t lengths[INSERTIONS];
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Generates INSERTIONS words drawn from WORDS distinct ones with a Zipf distribution (s = 1),
+ * as in natural language: the word of rank k is drawn with a probability proportional to 1/k. */
+static void generate(void);
+
+/* Returns the current value of a monotonic clock, in seconds. */
+static double now(void);
+
+static void* produce(void *producer)
+    __attribute__((nonnull));
+
+/* Inserts all the words into a concurrent TRIE using `threads` producers.
+ *
+ * Returns the elapsed time, or a negative value on failure.
+ */
+static double run_concurrent(unsigned threads);
+
+/* Inserts all the words into a plain TRIE in a single thread.
+ *
+ * Returns the elapsed time, or a negative value on failure.
+ */
+static double run_plain(void);
+
+/* Prints a single row of the results. */
+static void report(const char *restrict variant, double elapsed)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+int main(void) {
+    generate();
+
+    printf("%d insertions of %d distinct Zipf-distributed words, %ld CPUs online\n",
+            INSERTIONS, WORDS, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-12s %8s %12s\n", "variant", "seconds", "Minserts/s");
+
+    report("trie", run_plain());
+
+    for(unsigned threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        char variant[16];
+        snprintf(variant, sizeof(variant), "ctrie x%u", threads);
+        report(variant, run_concurrent(threads));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+void generate(void) {
+    /* The cumulative distribution of the ranks */
+    static double cdf[WORDS];
+    double sum = 0;
+    for(size_t rank = 0; rank < WORDS; ++rank) {
+        sum += 1.0 / (rank + 1);
+        cdf[rank] = sum;
+    }
+
+    uint64_t state = 42;
+
+    for(size_t index = 0; index < INSERTIONS; ++index) {
+        /* xorshift64, scaled to a uniform value in [0, sum) */
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        double uniform = (state >> 11) * 0x1p-53 * sum;
+
+        /* The first rank whose cumulative probability exceeds the uniform value */
+        size_t low = 0, high = WORDS - 1;
+        while(low < high) {
+            size_t middle = low + (high - low) / 2;
+            if(cdf[middle] > uniform)
+                high = middle;
+            else
+                low = middle + 1;
+        }
+
+        lengths[index] = snprintf(words[index], sizeof(words[index]), "%x", (unsigned) low);
+    }
+}
+
+double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+void* produce(void *_producer) {
+    struct producer *producer = _producer;
+
+    producer->ok = true;
+    for(size_t index = producer->begin; producer->ok && index < producer->end; ++index)
+        producer->ok = ctrie_insert(producer->trie, words[index], lengths[index]);
+
+    return NULL;
+}
+
+double run_concurrent(unsigned threads) {
+    struct ctrie *trie = ctrie_create();
+    if(!trie)
+        return -1;
+
+    pthread_t ids[MAX_THREADS];
+    struct producer producers[MAX_THREADS];
+    bool ok = true;
+
+    double start = now();
+
+    for(unsigned thread = 0; thread < threads; ++thread) {
+        producers[thread] = (struct producer) {
+            .trie = trie,
+            .begin = (size_t) INSERTIONS * thread / threads,
+            .end = (size_t) INSERTIONS * (thread + 1) / threads,
+            .ok = false,
+        };
+
+        if(pthread_create(&ids[thread], NULL, &produce, &producers[thread]) != 0) {
+            threads = thread;
+            ok = false;
+        }
+    }
+
+    for(unsigned thread = 0; thread < threads; ++thread) {
+        pthread_join(ids[thread], NULL);
+        ok = ok && producers[thread].ok;
+    }
+
+    double elapsed = now() - start;
+
+    ctrie_free(trie);
+    return ok ? elapsed : -1;
+}
+
+double run_plain(void) {
+    struct trie *trie = trie_create();
+    if(!trie)
+        return -1;
+
+    bool ok = true;
+    double start = now();
+
+    for(size_t index = 0; ok && index < INSERTIONS; ++index)
+        ok = trie_insert(trie, words[index], lengths[index]);
+
+    double elapsed = now() - start;
+
+    trie_free(trie);
+    return ok ? elapsed : -1;
+}
+
+void report(const char *variant, double elapsed) {
+    if(elapsed < 0)
+        printf("%-12s %8s %12s\n", variant, "failed", "-");
+    else
+        printf("%-12s %8.3f %12.2f\n", variant, elapsed, INSERTIONS / elapsed / 1e6);
+}
@@ -2,15 +2,81 @@
 #include "defines.h"
 #include "common.h"
 
+#include <errno.h>
+#include <getopt.h>
 #include <security/pam_appl.h>
 #include <security/pam_misc.h>
+#include <stdlib.h>
 
 static struct pam_conv conv = {
     .conv = misc_conv,
     .appdata_ptr = NULL
 };
 
-int main() {
+#define DEFAULT_SLOWEST_LINES 10
+
+#define USAGE "Usage: %s [--latency] [--slowest N] [--vocab FILE] [--cache BYTES]"
+
+static const struct option long_options[] = {
+    { "latency", no_argument, NULL, 'l' },
+    { "slowest", required_argument, NULL, 's' },
+    { "vocab", required_argument, NULL, 'v' },
+    { "cache", required_argument, NULL, 'c' },
+    { NULL, 0, NULL, 0 }
+};
+
+/* Parses a non-negative decimal number from a command-line argument */
+static size_t parse_size(const char *arg, const char *name) {
+    char *end;
+    errno = 0;
+    unsigned long long value = strtoull(arg, &end, 10);
+    if(errno != 0 || *arg == '\0' || *arg == '-' || *end != '\0')
+        fail(WITHOUT_ERRNO, "Invalid value of %s: %s", name, arg);
+    return value;
+}
+
+/* Parses the command-line arguments.
+ *
+ * The vocabulary is not loaded here, its path is stored in `vocabulary_path`.
+ */
+static struct bsk_options parse_options(int argc, char **argv, const char **vocabulary_path) {
+    struct bsk_options options = {
+        .vocabulary = NULL,
+        .cache_size = 0,
+        .latency = false,
+        .slowest_lines = DEFAULT_SLOWEST_LINES,
+    };
+
+    int opt;
+    while((opt = getopt_long(argc, argv, "ls:v:c:", long_options, NULL)) != -1) {
+        switch(opt) {
+            case 'l':
+                options.latency = true;
+                break;
+            case 's':
+                options.slowest_lines = parse_size(optarg, "--slowest");
+                break;
+            case 'v':
+                *vocabulary_path = optarg;
+                break;
+            case 'c':
+                options.cache_size = parse_size(optarg, "--cache");
+                break;
+            default:
+                fail(WITHOUT_ERRNO, USAGE, argv[0]);
+        }
+    }
+
+    if(optind != argc)
+        fail(WITHOUT_ERRNO, USAGE, argv[0]);
+
+    return options;
+}
+
+int main(int argc, char **argv) {
+    const char *vocabulary_path = NULL;
+    struct bsk_options options = parse_options(argc, argv, &vocabulary_path);
+
     pam_handle_t *pamh;
     int r = pam_start(BSK_SERVICE_NAME, NULL, &conv, &pamh);
     if(r != PAM_SUCCESS)
@@ -32,5 +98,18 @@ int main() {
 
     pam_end(pamh, PAM_SUCCESS);
 
-    return run(stdin, stdout);
+    struct bsk_vocabulary *vocabulary = NULL;
+    if(vocabulary_path) {
+        vocabulary = bsk_vocabulary_load(vocabulary_path);
+        if(!vocabulary)
+            fail(WITH_ERRNO, "Unable to load the vocabulary %s", vocabulary_path);
+    }
+    options.vocabulary = vocabulary;
+
+    r = run(stdin, stdout, &options);
+
+    if(vocabulary)
+        bsk_vocabulary_free(vocabulary);
+
+    return r;
 }
@@ -0,0 +1,265 @@
+#include "concurrent_trie.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The assumed size of a cache line, the alignment and the size of a counter */
+#define CACHE_LINE 64
+
+/* Represents a node in a concurrent TRIE.
+ *
+ * The children of a node form a singly linked list sorted by key. Nodes are only
+ * ever added to the list (with a compare-and-swap on the link preceding them) and
+ * never removed while the TRIE is shared, so a reader holding a pointer to a node
+ * can always safely dereference it and no deferred reclamation scheme is needed.
+ *
+ * The fields read while traversing are only written when a child is added. The counter,
+ * written by every insertion of the word, lives on a cache line of its own, so that
+ * counting a frequent word does not keep invalidating the line other threads traverse.
+ */
+struct ctrie_node {
+    /* The first child of the current node, NULL if none. */
+    _Atomic(struct ctrie_node *) children;
+
+    /* The next sibling (with a greater key), NULL if none. */
+    _Atomic(struct ctrie_node *) next;
+
+    /* A counter indicating how many words end in this node, NULL until the first one does. */
+    _Atomic(atomic_size_t *) counter;
+
+    /* The character on the edge leading to this node. */
+    char key;
+};
+
+struct ctrie {
+    struct ctrie_node *root;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Creates a concurrent TRIE node. Returns NULL if out of memory. */
+static struct ctrie_node* node_create(char key);
+
+/* Deletes a concurrent TRIE node recursively. Not thread-safe. */
+static void node_free_recursively(struct ctrie_node *restrict node);
+
+/* Returns the counter of `node`, creating it if needed. Returns NULL if out of memory. */
+static atomic_size_t* node_counter(struct ctrie_node *restrict node)
+    __attribute__((nonnull));
+
+/* Returns how many words end in `node`. */
+static size_t node_count(const struct ctrie_node *restrict node)
+    __attribute__((nonnull));
+
+/* Returns the child of `node` with the given key, NULL if none. */
+static const struct ctrie_node* node_find_child(const struct ctrie_node *restrict node, char key)
+    __attribute__((nonnull));
+
+/* Returns the child of `node` with the given key, creating it if needed. Returns NULL if out of memory. */
+static struct ctrie_node* node_child(struct ctrie_node *restrict node, char key)
+    __attribute__((nonnull));
+
+struct ctrie_get_even_data {
+    struct unbounded_string *current;
+    struct trie_get_even_response result;
+
+    /* Set if the search ran out of memory */
+    bool failed;
+};
+
+static void node_get_even(const struct ctrie_node *restrict node, struct ctrie_get_even_data *restrict data)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+struct ctrie* ctrie_create(void) {
+    struct ctrie *trie = calloc(1, sizeof(struct ctrie));
+
+    if(!trie)
+        return NULL;
+
+    trie->root = node_create(0);
+    if(!trie->root) {
+        free(trie);
+        return NULL;
+    }
+
+    return trie;
+}
+
+void ctrie_free(struct ctrie *trie) {
+    node_free_recursively(trie->root);
+    free(trie);
+}
+
+bool ctrie_insert(struct ctrie *trie, const char *word, size_t length) {
+    struct ctrie_node *node = trie->root;
+
+    for(size_t index = 0; index < length; ++index) {
+        node = node_child(node, word[index]);
+        if(!node)
+            return false;
+    }
+
+    atomic_size_t *counter = node_counter(node);
+    if(!counter)
+        return false;
+
+    atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+    return true;
+}
+
+size_t ctrie_count(const struct ctrie *trie, const char *word, size_t length) {
+    const struct ctrie_node *node = trie->root;
+
+    for(size_t index = 0; node && index < length; ++index)
+        node = node_find_child(node, word[index]);
+
+    return node ? node_count(node) : 0;
+}
+
+bool ctrie_get_even(struct ctrie *trie, struct trie_get_even_response *response) {
+    struct ctrie_get_even_data data = {
+        .current = us_from_string(""),
+        .result = {
+            .word = NULL,
+            .count = 0
+        },
+        .failed = false
+    };
+
+    if(!data.current)
+        return false;
+
+    node_get_even(trie->root, &data);
+
+    us_free(data.current);
+    *response = data.result;
+    return !data.failed;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+struct ctrie_node* node_create(char key) {
+    struct ctrie_node *node = malloc(sizeof(struct ctrie_node));
+    if(!node)
+        return NULL;
+
+    atomic_init(&node->children, NULL);
+    atomic_init(&node->next, NULL);
+    atomic_init(&node->counter, NULL);
+    node->key = key;
+
+    return node;
+}
+
+void node_free_recursively(struct ctrie_node *node) {
+    while(node) {
+        struct ctrie_node *next = atomic_load_explicit(&node->next, memory_order_relaxed);
+        node_free_recursively(atomic_load_explicit(&node->children, memory_order_relaxed));
+        free(atomic_load_explicit(&node->counter, memory_order_relaxed));
+        free(node);
+        node = next;
+    }
+}
+
+atomic_size_t* node_counter(struct ctrie_node *node) {
+    atomic_size_t *counter = atomic_load_explicit(&node->counter, memory_order_acquire);
+    if(counter)
+        return counter;
+
+    atomic_size_t *fresh = aligned_alloc(CACHE_LINE, CACHE_LINE);
+    if(!fresh)
+        return NULL;
+    atomic_init(fresh, 0);
+
+    /* On failure `counter` holds the one installed by another thread */
+    if(atomic_compare_exchange_strong_explicit(&node->counter, &counter, fresh,
+                memory_order_release, memory_order_acquire))
+        return fresh;
+
+    free(fresh);
+    return counter;
+}
+
+size_t node_count(const struct ctrie_node *node) {
+    atomic_size_t *counter = atomic_load_explicit(&node->counter, memory_order_acquire);
+    return counter ? atomic_load_explicit(counter, memory_order_relaxed) : 0;
+}
+
+const struct ctrie_node* node_find_child(const struct ctrie_node *node, char key) {
+    const struct ctrie_node *child = atomic_load_explicit(&node->children, memory_order_acquire);
+
+    while(child && child->key < key)
+        child = atomic_load_explicit(&child->next, memory_order_acquire);
+
+    return child && child->key == key ? child : NULL;
+}
+
+struct ctrie_node* node_child(struct ctrie_node *node, char key) {
+    /* A node allocated by this thread, but not yet published */
+    struct ctrie_node *fresh = NULL;
+
+    _Atomic(struct ctrie_node *) *link = &node->children;
+    struct ctrie_node *current = atomic_load_explicit(link, memory_order_acquire);
+
+    while(true) {
+        while(current && current->key < key) {
+            link = &current->next;
+            current = atomic_load_explicit(link, memory_order_acquire);
+        }
+
+        if(current && current->key == key) {
+            /* Somebody else was faster, our node was never visible to other threads */
+            free(fresh);
+            return current;
+        }
+
+        if(!fresh) {
+            fresh = node_create(key);
+            if(!fresh)
+                return NULL;
+        }
+
+        atomic_store_explicit(&fresh->next, current, memory_order_relaxed);
+
+        /* On failure `current` is reloaded. Since the list only grows and stays sorted,
+         * the search may be resumed from `link` rather than from the beginning. */
+        if(atomic_compare_exchange_weak_explicit(link, &current, fresh,
+                    memory_order_release, memory_order_acquire))
+            return fresh;
+    }
+}
+
+void node_get_even(const struct ctrie_node *node, struct ctrie_get_even_data *data) {
+    size_t counter = node_count(node);
+
+    if(counter > 0 && counter % 2 == 0) {
+        data->result.count = counter;
+        data->result.word = strndup(us_to_string(data->current), us_length(data->current));
+        if(!data->result.word)
+            data->failed = true;
+        return;
+    }
+
+    const struct ctrie_node *child = atomic_load_explicit(&node->children, memory_order_acquire);
+    while(child && !data->result.word && !data->failed) {
+        if(!us_push(data->current, child->key)) {
+            data->failed = true;
+            return;
+        }
+
+        node_get_even(child, data);
+        us_pop(data->current);
+
+        child = atomic_load_explicit(&child->next, memory_order_acquire);
+    }
+}
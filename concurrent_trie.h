@@ -0,0 +1,44 @@
+#ifndef _CONCURRENT_TRIE_H
+#define _CONCURRENT_TRIE_H
+
+#include "trie.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/* An opaque type representing a TRIE that may be shared between threads.
+ *
+ * Any number of threads may call `ctrie_insert` and `ctrie_get_even` concurrently
+ * without external locking. Only `ctrie_free` requires that no other thread
+ * is using the TRIE anymore.
+ */
+struct ctrie;
+
+/* Creates a new, empty concurrent TRIE. Returns NULL if out of memory. */
+struct ctrie* ctrie_create(void)
+    __attribute__((warn_unused_result));
+
+/* Frees the resources held by a concurrent TRIE */
+void ctrie_free(struct ctrie *restrict)
+    __attribute__((nonnull));
+
+/* Inserts a word into a concurrent TRIE. Lock-free.
+ *
+ * Returns false if out of memory. The TRIE stays valid then, but the word is not counted.
+ */
+bool ctrie_insert(struct ctrie *restrict tree, const char *restrict word, size_t length)
+    __attribute__((nonnull(1, 2), warn_unused_result));
+
+/* Returns how many times a word has been inserted so far. Lock-free. */
+size_t ctrie_count(const struct ctrie *restrict tree, const char *restrict word, size_t length)
+    __attribute__((nonnull(1, 2)));
+
+/* Gets an arbitrary word that has been inserted even (but positive) number of times.
+ *
+ * Semantics are the same as in `trie_get_even`. Does not take any locks; when run
+ * concurrently with insertions, it observes some of them.
+ */
+bool ctrie_get_even(struct ctrie *restrict, struct trie_get_even_response *restrict response)
+    __attribute__((nonnull, warn_unused_result));
+
+#endif /* !_CONCURRENT_TRIE_H */
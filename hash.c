@@ -0,0 +1,104 @@
+#include "hash.h"
+
+#include <string.h>
+
+#define PRIME1 0x9e3779b97f4a7c15u
+#define PRIME2 0xc2b2ae3d27d4eb4fu
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Rotates a 64-bit value left. */
+static inline uint64_t rotl64(uint64_t value, int shift)
+    __attribute__((const));
+
+/* Reads up to 8 bytes as a little-endian value, regardless of the native byte order. */
+static inline uint64_t load_le64(const unsigned char *restrict bytes, size_t length)
+    __attribute__((nonnull, pure));
+
+/* A single SipRound. */
+static inline void sip_round(uint64_t *restrict v0, uint64_t *restrict v1, uint64_t *restrict v2, uint64_t *restrict v3)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+uint64_t hash_mix(uint64_t value) {
+    /* The finalizer of splitmix64 */
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9u;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebu;
+    value ^= value >> 31;
+    return value;
+}
+
+uint64_t hash64(const void *data, size_t length, uint64_t seed) {
+    const unsigned char *bytes = data;
+    uint64_t hash = seed ^ (length * PRIME1);
+
+    for(; length >= sizeof(uint64_t); bytes += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+        uint64_t chunk;
+        memcpy(&chunk, bytes, sizeof(uint64_t));
+        hash = (hash ^ hash_mix(chunk)) * PRIME2;
+    }
+
+    /* The tail is padded with zeroes, the length has already been accounted for */
+    uint64_t tail = 0;
+    memcpy(&tail, bytes, length);
+    hash = (hash ^ hash_mix(tail + PRIME1)) * PRIME2;
+
+    return hash_mix(hash);
+}
+
+uint64_t hash_keyed(const void *data, size_t length, const struct hash_key *key) {
+    const unsigned char *bytes = data;
+    uint64_t v0 = key->k0 ^ 0x736f6d6570736575u, v1 = key->k1 ^ 0x646f72616e646f6du;
+    uint64_t v2 = key->k0 ^ 0x6c7967656e657261u, v3 = key->k1 ^ 0x7465646279746573u;
+    size_t remaining = length;
+
+    for(; remaining >= sizeof(uint64_t); bytes += sizeof(uint64_t), remaining -= sizeof(uint64_t)) {
+        uint64_t chunk = load_le64(bytes, sizeof(uint64_t));
+        v3 ^= chunk;
+        sip_round(&v0, &v1, &v2, &v3);
+        sip_round(&v0, &v1, &v2, &v3);
+        v0 ^= chunk;
+    }
+
+    /* The tail (up to 7 bytes), with the low byte of the length on top */
+    uint64_t last = load_le64(bytes, remaining) | ((uint64_t) length << 56);
+    v3 ^= last;
+    sip_round(&v0, &v1, &v2, &v3);
+    sip_round(&v0, &v1, &v2, &v3);
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    for(int round = 0; round < 4; ++round)
+        sip_round(&v0, &v1, &v2, &v3);
+
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+uint64_t rotl64(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+uint64_t load_le64(const unsigned char *bytes, size_t length) {
+    uint64_t value = 0;
+    for(size_t index = length; index > 0; --index)
+        value = (value << 8) | bytes[index - 1];
+    return value;
+}
+
+void sip_round(uint64_t *v0, uint64_t *v1, uint64_t *v2, uint64_t *v3) {
+    *v0 += *v1; *v1 = rotl64(*v1, 13); *v1 ^= *v0; *v0 = rotl64(*v0, 32);
+    *v2 += *v3; *v3 = rotl64(*v3, 16); *v3 ^= *v2;
+    *v0 += *v3; *v3 = rotl64(*v3, 21); *v3 ^= *v0;
+    *v2 += *v1; *v1 = rotl64(*v1, 17); *v1 ^= *v2; *v2 = rotl64(*v2, 32);
+}
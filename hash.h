@@ -0,0 +1,28 @@
+#ifndef _HASH_H
+#define _HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* A secret 128-bit key of a keyed hash */
+struct hash_key {
+    uint64_t k0, k1;
+};
+
+/* Scrambles the bits of a 64-bit value (a bijection). */
+uint64_t hash_mix(uint64_t value)
+    __attribute__((const));
+
+/* Computes a seeded 64-bit hash of `length` bytes. Not suitable for cryptography. */
+uint64_t hash64(const void *restrict data, size_t length, uint64_t seed)
+    __attribute__((nonnull, pure));
+
+/* Computes a keyed 64-bit hash (SipHash-2-4) of `length` bytes.
+ *
+ * Unlike `hash64`, collisions cannot be chosen without knowing the key, so it is
+ * safe to use for hash tables filled with untrusted input.
+ */
+uint64_t hash_keyed(const void *restrict data, size_t length, const struct hash_key *restrict key)
+    __attribute__((nonnull, pure));
+
+#endif /* !_HASH_H */
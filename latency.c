@@ -0,0 +1,282 @@
+#include "latency.h"
+
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Every power of two is split into 2^SUB_BUCKET_BITS linear sub-buckets */
+#define SUB_BUCKET_BITS 5
+#define SUB_BUCKETS (1u << SUB_BUCKET_BITS)
+
+/* Values below 2 * SUB_BUCKETS are recorded exactly, one bucket each.
+ * Each of the remaining exponents (up to 63) adds SUB_BUCKETS buckets. */
+#define BUCKETS (2 * SUB_BUCKETS + (63 - SUB_BUCKET_BITS) * SUB_BUCKETS)
+
+/* A log-bucket histogram of nanosecond values */
+struct histogram {
+    uint64_t buckets[BUCKETS];
+    uint64_t count;
+    uint64_t max;
+};
+
+/* A single line remembered as one of the slowest ones */
+struct outlier {
+    /* The stream and the byte offset in it */
+    size_t stream, offset;
+    uint64_t build_time, query_time;
+};
+
+struct latency_stats {
+    struct histogram build, query, total;
+
+    /* The number of the current input stream */
+    size_t stream;
+
+    /* A min-heap (by total time) of the slowest lines seen so far */
+    struct outlier *slowest;
+    size_t slowest_count, slowest_capacity;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Returns the index of the bucket holding `value`. */
+static inline size_t bucket_index(uint64_t value)
+    __attribute__((const));
+
+/* Returns the greatest value held by the bucket `index`. */
+static inline uint64_t bucket_upper_bound(size_t index)
+    __attribute__((const));
+
+/* Adds a value to the histogram. */
+static void histogram_record(struct histogram *restrict histogram, uint64_t value)
+    __attribute__((nonnull));
+
+/* Returns an upper bound of the given percentile (from the range [0, 100]). */
+static uint64_t histogram_percentile(const struct histogram *restrict histogram, double percentile)
+    __attribute__((nonnull, pure));
+
+/* Writes a single line summarizing the histogram. */
+static void histogram_report(const struct histogram *restrict histogram, const char *restrict name, FILE *restrict out)
+    __attribute__((nonnull));
+
+/* Returns the total time spent on the line. */
+static inline uint64_t outlier_time(const struct outlier *restrict outlier)
+    __attribute__((nonnull, pure));
+
+/* Restores the heap property of `stats->slowest` downwards from `index`. */
+static void sift_down(struct latency_stats *restrict stats, size_t index)
+    __attribute__((nonnull));
+
+/* Restores the heap property of `stats->slowest` upwards from `index`. */
+static void sift_up(struct latency_stats *restrict stats, size_t index)
+    __attribute__((nonnull));
+
+/* Orders outliers from the slowest one, for qsort. */
+static int compare_outliers(const void *lhs, const void *rhs)
+    __attribute__((nonnull, pure));
+
+/*
+ * =================== Public functions ===================
+ */
+
+uint64_t latency_now(void) {
+    struct timespec now;
+    if(clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+        return 0;
+
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+struct latency_stats* latency_stats_create(size_t slowest_lines) {
+    struct latency_stats *stats = calloc(1, sizeof(struct latency_stats));
+    if(!stats)
+        return NULL;
+
+    if(slowest_lines > 0) {
+        stats->slowest = calloc(slowest_lines, sizeof(struct outlier));
+        if(!stats->slowest) {
+            latency_stats_free(stats);
+            return NULL;
+        }
+    }
+
+    stats->slowest_capacity = slowest_lines;
+    return stats;
+}
+
+void latency_stats_free(struct latency_stats *stats) {
+    free(stats->slowest);
+    free(stats);
+}
+
+void latency_stats_record(struct latency_stats *stats, size_t offset, uint64_t build_time, uint64_t query_time) {
+    histogram_record(&stats->build, build_time);
+    histogram_record(&stats->query, query_time);
+    histogram_record(&stats->total, build_time + query_time);
+
+    struct outlier outlier = {
+        .stream = stats->stream,
+        .offset = offset,
+        .build_time = build_time,
+        .query_time = query_time,
+    };
+
+    if(stats->slowest_count < stats->slowest_capacity) {
+        stats->slowest[stats->slowest_count] = outlier;
+        sift_up(stats, stats->slowest_count++);
+    }
+    else if(stats->slowest_count > 0 && outlier_time(&stats->slowest[0]) < outlier_time(&outlier)) {
+        stats->slowest[0] = outlier;
+        sift_down(stats, 0);
+    }
+}
+
+void latency_stats_next_stream(struct latency_stats *stats) {
+    stats->stream++;
+}
+
+void latency_stats_report(const struct latency_stats *stats, FILE *out) {
+    fprintf(out, "Latency statistics (%" PRIu64 " lines, nanoseconds):\n", stats->total.count);
+    histogram_report(&stats->build, "build", out);
+    histogram_report(&stats->query, "query", out);
+    histogram_report(&stats->total, "total", out);
+
+    if(stats->slowest_count == 0)
+        return;
+
+    /* The heap itself is left intact, so that the statistics may still be extended. If the
+     * copy cannot be allocated, the lines are reported in the heap order. */
+    struct outlier *copy = malloc(stats->slowest_count * sizeof(struct outlier));
+    const struct outlier *sorted = copy ? copy : stats->slowest;
+    if(copy) {
+        memcpy(copy, stats->slowest, stats->slowest_count * sizeof(struct outlier));
+        qsort(copy, stats->slowest_count, sizeof(struct outlier), &compare_outliers);
+    }
+
+    fprintf(out, "Slowest lines:\n");
+    for(size_t index = 0; index < stats->slowest_count; ++index) {
+        /* Offsets are ambiguous only if there was more than a single stream */
+        if(stats->stream > 0)
+            fprintf(out, "  stream %zu, ", sorted[index].stream);
+        else
+            fprintf(out, "  ");
+
+        fprintf(out, "offset %zu: %" PRIu64 " (build %" PRIu64 ", query %" PRIu64 ")\n",
+                sorted[index].offset, outlier_time(&sorted[index]),
+                sorted[index].build_time, sorted[index].query_time);
+    }
+
+    free(copy);
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+size_t bucket_index(uint64_t value) {
+    if(value < 2 * SUB_BUCKETS)
+        return value;
+
+    unsigned shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+}
+
+uint64_t bucket_upper_bound(size_t index) {
+    if(index < 2 * SUB_BUCKETS)
+        return index;
+
+    unsigned shift = (index - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+    uint64_t top = (index - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void histogram_record(struct histogram *histogram, uint64_t value) {
+    size_t index = bucket_index(value);
+    assert(index < BUCKETS);
+
+    histogram->buckets[index]++;
+    histogram->count++;
+    if(histogram->max < value)
+        histogram->max = value;
+}
+
+uint64_t histogram_percentile(const struct histogram *histogram, double percentile) {
+    if(histogram->count == 0)
+        return 0;
+
+    uint64_t rank = (uint64_t) (percentile / 100.0 * histogram->count + 0.5);
+    if(rank == 0)
+        rank = 1;
+
+    uint64_t seen = 0;
+    for(size_t index = 0; index < BUCKETS; ++index) {
+        seen += histogram->buckets[index];
+        if(seen >= rank) {
+            uint64_t bound = bucket_upper_bound(index);
+            return bound < histogram->max ? bound : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+void histogram_report(const struct histogram *histogram, const char *name, FILE *out) {
+    fprintf(out, "  %s: p50 %" PRIu64 ", p99 %" PRIu64 ", p99.9 %" PRIu64 ", max %" PRIu64 "\n", name,
+            histogram_percentile(histogram, 50.0),
+            histogram_percentile(histogram, 99.0),
+            histogram_percentile(histogram, 99.9),
+            histogram->max);
+}
+
+uint64_t outlier_time(const struct outlier *outlier) {
+    return outlier->build_time + outlier->query_time;
+}
+
+void sift_down(struct latency_stats *stats, size_t index) {
+    while(true) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1, right = 2 * index + 2;
+
+        if(left < stats->slowest_count && outlier_time(&stats->slowest[left]) < outlier_time(&stats->slowest[smallest]))
+            smallest = left;
+        if(right < stats->slowest_count && outlier_time(&stats->slowest[right]) < outlier_time(&stats->slowest[smallest]))
+            smallest = right;
+
+        if(smallest == index)
+            return;
+
+        struct outlier aux = stats->slowest[index];
+        stats->slowest[index] = stats->slowest[smallest];
+        stats->slowest[smallest] = aux;
+        index = smallest;
+    }
+}
+
+void sift_up(struct latency_stats *stats, size_t index) {
+    while(index > 0) {
+        size_t parent = (index - 1) / 2;
+        if(outlier_time(&stats->slowest[parent]) <= outlier_time(&stats->slowest[index]))
+            return;
+
+        struct outlier aux = stats->slowest[index];
+        stats->slowest[index] = stats->slowest[parent];
+        stats->slowest[parent] = aux;
+        index = parent;
+    }
+}
+
+int compare_outliers(const void *_lhs, const void *_rhs) {
+    uint64_t lhs = outlier_time(_lhs), rhs = outlier_time(_rhs);
+
+    if(lhs > rhs)
+        return -1;
+    else if(lhs == rhs)
+        return 0;
+    else
+        return 1;
+}
@@ -0,0 +1,46 @@
+#ifndef _LATENCY_H
+#define _LATENCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* An opaque type collecting per-line latency samples.
+ *
+ * Samples are kept in log-bucket (HDR-style) histograms: every power of two is split
+ * into a fixed number of linear sub-buckets, so percentiles are reported with a
+ * bounded relative error and in constant memory.
+ */
+struct latency_stats;
+
+/* Returns the current value of a monotonic clock, in nanoseconds, or 0 if it is unavailable. */
+uint64_t latency_now(void);
+
+/* Creates new, empty latency statistics remembering `slowest_lines` slowest lines.
+ *
+ * Returns NULL if out of memory.
+ */
+struct latency_stats* latency_stats_create(size_t slowest_lines)
+    __attribute__((warn_unused_result));
+
+/* Frees the resources held by latency statistics */
+void latency_stats_free(struct latency_stats *restrict)
+    __attribute__((nonnull));
+
+/* Records the timings of a single line starting at byte `offset` of the current input stream. */
+void latency_stats_record(struct latency_stats *restrict stats, size_t offset,
+            uint64_t build_time, uint64_t query_time)
+    __attribute__((nonnull));
+
+/* Starts a new input stream. Offsets recorded from now on refer to it.
+ *
+ * Streams are numbered from 0, the number is reported with each of the slowest lines.
+ */
+void latency_stats_next_stream(struct latency_stats *restrict stats)
+    __attribute__((nonnull));
+
+/* Writes the percentiles and the slowest lines to `out`. */
+void latency_stats_report(const struct latency_stats *restrict stats, FILE *restrict out)
+    __attribute__((nonnull));
+
+#endif /* !_LATENCY_H */
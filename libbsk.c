@@ -0,0 +1,381 @@
+#include "libbsk.h"
+#include "latency.h"
+#include "line_cache.h"
+#include "trie.h"
+#include "unbounded_string.h"
+#include "vocabulary.h"
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Line buffers grown above this size are shrunk back after the line */
+#define LINE_HIGH_WATER 65536
+
+/* Likewise for TRIEs: a line of LINE_HIGH_WATER bytes never needs more nodes */
+#define TRIE_HIGH_WATER (LINE_HIGH_WATER + 1)
+
+/* The public handle of a vocabulary */
+struct bsk_vocabulary {
+    struct vocabulary *vocabulary;
+};
+
+struct bsk_context {
+    struct bsk_options options;
+
+    /* The vocabulary from the options, NULL if none */
+    const struct vocabulary *vocabulary;
+
+    bsk_result_callback callback;
+    void *callback_data;
+
+    /* The current, possibly incomplete, line */
+    struct unbounded_string *line;
+
+    /* The words of the current line, NULL in the vocabulary mode */
+    struct trie *trie;
+
+    /* In the vocabulary mode: the counter of every word of the vocabulary and
+     * the indices of the words seen in the current line, in the order of appearance */
+    size_t *counters;
+    size_t *seen;
+    size_t seen_count;
+
+    /* The cache of results of previously seen lines, NULL if disabled */
+    struct line_cache *cache;
+
+    /* The latency statistics, NULL if disabled */
+    struct latency_stats *latency;
+
+    /* The number of bytes of the stream consumed so far and the offset of the current line */
+    size_t offset, line_offset;
+
+    /* Whether the terminating dot has been seen and whether processing has failed */
+    bool done, failed;
+};
+
+/* A word counted even number of times */
+struct even_word {
+    /* The word, NULL if none */
+    const char *word;
+    size_t count;
+
+    /* The memory to be freed after reporting the word, NULL if none */
+    char *allocated;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Counts the words of the buffered line and reports the result. Returns false if out of memory. */
+static bool process_line(struct bsk_context *restrict context)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Counts all the words of the buffered line. Returns false if out of memory. */
+static bool count_words(struct bsk_context *restrict context)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Counts a single word, either in the TRIE or in the vocabulary counters. Returns false if out of memory. */
+static inline bool count_word(struct bsk_context *restrict context, const char *restrict word, size_t length)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Finds a word counted even number of times in the current line. Returns false if out of memory. */
+static bool find_even(struct bsk_context *restrict context, struct even_word *restrict result)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Returns whether the word `lhs` precedes `rhs` in the order of a TRIE search: bytes
+ * compared as `char`, and a word before its extensions. */
+static bool precedes(const char *restrict lhs, size_t lhs_length, const char *restrict rhs, size_t rhs_length)
+    __attribute__((nonnull, pure));
+
+/* Marks the stream as failed. Always returns BSK_ERROR. */
+static enum bsk_status fail_stream(struct bsk_context *restrict context)
+    __attribute__((nonnull));
+
+/* Forgets the words of the current line. */
+static void clear_counters(struct bsk_context *restrict context)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+struct bsk_vocabulary* bsk_vocabulary_load(const char *path) {
+    struct bsk_vocabulary *handle = malloc(sizeof(struct bsk_vocabulary));
+    if(!handle)
+        return NULL;
+
+    handle->vocabulary = vocabulary_load(path);
+    if(!handle->vocabulary) {
+        free(handle);
+        return NULL;
+    }
+
+    return handle;
+}
+
+void bsk_vocabulary_free(struct bsk_vocabulary *handle) {
+    vocabulary_free(handle->vocabulary);
+    free(handle);
+}
+
+struct bsk_context* bsk_context_create(const struct bsk_options *options, bsk_result_callback callback, void *data) {
+    struct bsk_context *context = calloc(1, sizeof(struct bsk_context));
+    if(!context)
+        return NULL;
+
+    context->options = *options;
+    context->callback = callback;
+    context->callback_data = data;
+    context->line = us_from_string("");
+    bool ok = context->line != NULL;
+
+    if(options->vocabulary) {
+        context->vocabulary = options->vocabulary->vocabulary;
+
+        size_t size = vocabulary_size(context->vocabulary);
+        context->counters = calloc(size + 1, sizeof(size_t));
+        context->seen = calloc(size + 1, sizeof(size_t));
+        ok = ok && context->counters && context->seen;
+    }
+    else {
+        context->trie = trie_create();
+        ok = ok && context->trie;
+    }
+
+    if(options->cache_size > 0) {
+        context->cache = line_cache_create(options->cache_size);
+        ok = ok && context->cache;
+    }
+
+    if(options->latency) {
+        context->latency = latency_stats_create(options->slowest_lines);
+        ok = ok && context->latency;
+    }
+
+    if(!ok) {
+        bsk_context_free(context);
+        return NULL;
+    }
+
+    return context;
+}
+
+void bsk_context_free(struct bsk_context *context) {
+    /* Also called on partially created contexts */
+    if(context->latency)
+        latency_stats_free(context->latency);
+    if(context->cache)
+        line_cache_free(context->cache);
+    if(context->trie)
+        trie_free(context->trie);
+    if(context->line)
+        us_free(context->line);
+
+    free(context->seen);
+    free(context->counters);
+    free(context);
+}
+
+enum bsk_status bsk_feed(struct bsk_context *context, const char *buffer, size_t length) {
+    size_t begin = 0;
+
+    if(context->failed)
+        return BSK_ERROR;
+
+    while(!context->done && begin < length) {
+        size_t end = begin;
+        while(end < length && buffer[end] != '\n' && buffer[end] != '.')
+            ++end;
+
+        if(!us_append(context->line, buffer + begin, end - begin))
+            return fail_stream(context);
+        context->offset += end - begin;
+
+        if(end == length)
+            break;
+
+        if(buffer[end] == '.') {
+            context->done = true;
+            break;
+        }
+
+        ++context->offset;
+        if(!process_line(context))
+            return fail_stream(context);
+        begin = end + 1;
+    }
+
+    return context->done ? BSK_DONE : BSK_CONTINUE;
+}
+
+enum bsk_status bsk_finish(struct bsk_context *context) {
+    if(context->failed)
+        return BSK_ERROR;
+
+    if(!context->done && context->offset > context->line_offset && !process_line(context))
+        return fail_stream(context);
+
+    context->done = true;
+    return BSK_DONE;
+}
+
+void bsk_reset(struct bsk_context *context) {
+    us_clear(context->line);
+    us_trim(context->line, LINE_HIGH_WATER);
+    clear_counters(context);
+
+    context->offset = context->line_offset = 0;
+    context->done = context->failed = false;
+
+    if(context->latency)
+        latency_stats_next_stream(context->latency);
+}
+
+void bsk_report_stats(const struct bsk_context *context, FILE *out) {
+    if(context->cache)
+        line_cache_report(context->cache, out);
+    if(context->latency)
+        latency_stats_report(context->latency, out);
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+bool process_line(struct bsk_context *context) {
+    const char *line = us_to_string(context->line);
+    size_t length = us_length(context->line);
+
+    uint64_t build_start = context->latency ? latency_now() : 0, query_start = build_start;
+    struct even_word result = {
+        .word = NULL,
+        .count = 0,
+        .allocated = NULL,
+    };
+    uint64_t hash;
+
+    /* A cached line is neither tokenized nor counted, its lookup is accounted as the query */
+    if(!context->cache || !line_cache_get(context->cache, line, length, &result.word, &result.count, &hash)) {
+        if(!count_words(context))
+            return false;
+
+        query_start = context->latency ? latency_now() : 0;
+        if(!find_even(context, &result))
+            return false;
+
+        if(context->cache)
+            line_cache_put(context->cache, line, length, hash, result.word, result.count);
+    }
+
+    if(context->latency)
+        latency_stats_record(context->latency, context->line_offset,
+                query_start - build_start, latency_now() - query_start);
+
+    if(result.word)
+        context->callback(line, length, result.word, result.count, context->callback_data);
+    free(result.allocated);
+
+    us_clear(context->line);
+    us_trim(context->line, LINE_HIGH_WATER);
+    clear_counters(context);
+    context->line_offset = context->offset;
+
+    return true;
+}
+
+bool count_words(struct bsk_context *context) {
+    const char *line = us_to_string(context->line);
+    size_t length = us_length(context->line);
+    size_t word_begin = 0;
+
+    for(size_t index = 0; index < length; ++index) {
+        if(!isspace((unsigned char) line[index]))
+            continue;
+
+        if(word_begin != index && !count_word(context, line + word_begin, index - word_begin))
+            return false;
+        word_begin = index + 1;
+    }
+
+    if(word_begin != length)
+        return count_word(context, line + word_begin, length - word_begin);
+
+    return true;
+}
+
+bool count_word(struct bsk_context *context, const char *word, size_t length) {
+    if(!context->vocabulary)
+        return trie_insert(context->trie, word, length);
+
+    size_t index = vocabulary_find(context->vocabulary, word, length);
+    if(index == VOCABULARY_MISSING)
+        return true;
+
+    if(context->counters[index]++ == 0)
+        context->seen[context->seen_count++] = index;
+    return true;
+}
+
+bool find_even(struct bsk_context *context, struct even_word *result) {
+    if(!context->vocabulary) {
+        struct trie_get_even_response response;
+        if(!trie_get_even(context->trie, &response))
+            return false;
+
+        result->word = result->allocated = response.word;
+        result->count = response.count;
+        return true;
+    }
+
+    /* The same word as the TRIE would find: the vocabulary only filters the words out */
+    const struct vocabulary *vocabulary = context->vocabulary;
+    size_t best = VOCABULARY_MISSING;
+
+    for(size_t index = 0; index < context->seen_count; ++index) {
+        size_t word = context->seen[index];
+        if(context->counters[word] % 2 != 0)
+            continue;
+
+        if(best == VOCABULARY_MISSING || precedes(vocabulary_word(vocabulary, word), vocabulary_length(vocabulary, word),
+                    vocabulary_word(vocabulary, best), vocabulary_length(vocabulary, best)))
+            best = word;
+    }
+
+    if(best != VOCABULARY_MISSING) {
+        result->word = vocabulary_word(vocabulary, best);
+        result->count = context->counters[best];
+    }
+
+    return true;
+}
+
+void clear_counters(struct bsk_context *context) {
+    if(!context->vocabulary) {
+        trie_clear(context->trie);
+        trie_trim(context->trie, TRIE_HIGH_WATER);
+        return;
+    }
+
+    for(size_t index = 0; index < context->seen_count; ++index)
+        context->counters[context->seen[index]] = 0;
+    context->seen_count = 0;
+}
+
+bool precedes(const char *lhs, size_t lhs_length, const char *rhs, size_t rhs_length) {
+    size_t length = lhs_length < rhs_length ? lhs_length : rhs_length;
+
+    for(size_t index = 0; index < length; ++index)
+        if(lhs[index] != rhs[index])
+            return lhs[index] < rhs[index];
+
+    return lhs_length < rhs_length;
+}
+
+enum bsk_status fail_stream(struct bsk_context *context) {
+    context->failed = true;
+    return BSK_ERROR;
+}
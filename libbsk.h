@@ -0,0 +1,108 @@
+#ifndef _LIBBSK_H
+#define _LIBBSK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Marks the functions exported from the shared library, everything else is hidden */
+#define BSK_API __attribute__((visibility("default")))
+
+/* An opaque type representing a fixed set of words, see `bsk_vocabulary_load`. */
+struct bsk_vocabulary;
+
+/* Options altering the behaviour of a processing context */
+struct bsk_options {
+    /* If not NULL, only the words from this vocabulary are counted. The vocabulary
+     * is not copied: it must outlive every context created with these options. */
+    const struct bsk_vocabulary *vocabulary;
+
+    /* The memory limit (in bytes) of the cache of results of repeated lines, 0 disables it. */
+    size_t cache_size;
+
+    /* Whether to time every line and collect latency statistics. */
+    bool latency;
+
+    /* How many of the slowest lines are remembered, if `latency` is set. */
+    size_t slowest_lines;
+};
+
+/* Reads a vocabulary from the file `path`, containing words separated by whitespace.
+ *
+ * Returns NULL (with `errno` set) on failure. A vocabulary is immutable, so it may be
+ * shared by any number of contexts, also from different threads.
+ */
+BSK_API struct bsk_vocabulary* bsk_vocabulary_load(const char *restrict path)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Frees a vocabulary. No context using it may exist anymore. */
+BSK_API void bsk_vocabulary_free(struct bsk_vocabulary *restrict)
+    __attribute__((nonnull));
+
+/* Called for every line with a word inserted an even (but positive) number of times.
+ *
+ * `line` is not null-terminated and does not contain the newline, `word` is
+ * null-terminated. Both are only valid during the call.
+ */
+typedef void (*bsk_result_callback)(const char *restrict line, size_t line_length,
+            const char *restrict word, size_t count, void *restrict data);
+
+/* The state of an input stream after feeding it into a context */
+enum bsk_status {
+    /* More input is expected. */
+    BSK_CONTINUE,
+
+    /* The stream has ended; the rest of it, if any, is ignored. */
+    BSK_DONE,
+
+    /* Processing failed (with `errno` set); the stream must be restarted with `bsk_reset`. */
+    BSK_ERROR,
+};
+
+/* An opaque type representing a processing context.
+ *
+ * A context owns the line buffer and the counting structures, which are reused
+ * between lines and between streams. A context must not be shared between threads.
+ */
+struct bsk_context;
+
+/* Creates a new processing context, reporting the results to `callback`.
+ *
+ * Returns NULL if out of memory.
+ */
+BSK_API struct bsk_context* bsk_context_create(const struct bsk_options *restrict options,
+            bsk_result_callback callback, void *restrict data)
+    __attribute__((nonnull(1, 2), warn_unused_result));
+
+/* Frees the resources held by a processing context */
+BSK_API void bsk_context_free(struct bsk_context *restrict)
+    __attribute__((nonnull));
+
+/* Feeds the next `length` bytes of the input stream into the context.
+ *
+ * Lines may be split arbitrarily between the calls. Returns BSK_DONE once the
+ * terminating dot has been seen, BSK_ERROR if out of memory.
+ */
+BSK_API enum bsk_status bsk_feed(struct bsk_context *restrict, const char *restrict buffer, size_t length)
+    __attribute__((nonnull));
+
+/* Signals the end of the input stream, processing the last unterminated line, if any.
+ *
+ * Returns BSK_DONE, or BSK_ERROR if out of memory.
+ */
+BSK_API enum bsk_status bsk_finish(struct bsk_context *restrict)
+    __attribute__((nonnull));
+
+/* Prepares the context for a new input stream. Statistics and cached results are kept.
+ *
+ * Offsets of the slowest lines start from 0 again, so they are reported along with the
+ * number of their stream (counted from 0) once a context has been reset.
+ */
+BSK_API void bsk_reset(struct bsk_context *restrict)
+    __attribute__((nonnull));
+
+/* Writes the collected statistics, if any, to `out`. */
+BSK_API void bsk_report_stats(const struct bsk_context *restrict, FILE *restrict out)
+    __attribute__((nonnull));
+
+#endif /* !_LIBBSK_H */
@@ -0,0 +1,310 @@
+#include "line_cache.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define INITIAL_BUCKETS 64
+
+/* A cached result */
+struct entry {
+    /* The next entry in the same bucket */
+    struct entry *chain;
+
+    /* The neighbours on the LRU list, the more recently used one first */
+    struct entry *newer, *older;
+
+    uint64_t hash;
+    size_t length;
+
+    /* The word (NULL if none), its length and its count */
+    const char *word;
+    size_t word_length, count;
+
+    /* The line, followed by the null-terminated word */
+    char data[];
+};
+
+struct line_cache {
+    /* The hash table, the number of buckets is a power of two */
+    struct entry **buckets;
+    size_t bucket_count, entry_count;
+
+    /* The secret key of the hash of the lines */
+    struct hash_key key;
+
+    /* The ends of the LRU list */
+    struct entry *newest, *oldest;
+
+    /* The memory used by the entries and the buckets, and the limit */
+    size_t size, capacity;
+
+    size_t hits, misses;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Returns the number of bytes accounted for an entry. */
+static inline size_t entry_size(size_t length, size_t word_length)
+    __attribute__((const));
+
+/* Returns the bucket for the given hash. */
+static inline struct entry** bucket_of(const struct line_cache *restrict cache, uint64_t hash)
+    __attribute__((nonnull, returns_nonnull, pure));
+
+/* Finds the entry for a line, NULL if none. */
+static struct entry* find(const struct line_cache *restrict cache, uint64_t hash, const char *restrict line, size_t length)
+    __attribute__((nonnull));
+
+/* Reads a random key from the system. Returns false (with `errno` set) on failure. */
+static bool random_key(struct hash_key *restrict key)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Removes an entry from the LRU list. */
+static void unlink_lru(struct line_cache *restrict cache, struct entry *restrict entry)
+    __attribute__((nonnull));
+
+/* Inserts an entry at the front of the LRU list. */
+static void link_lru(struct line_cache *restrict cache, struct entry *restrict entry)
+    __attribute__((nonnull));
+
+/* Removes the least recently used entry. */
+static void evict(struct line_cache *restrict cache)
+    __attribute__((nonnull));
+
+/* Doubles the number of buckets, evicting entries to make room for them if needed.
+ *
+ * Keeps the current buckets if out of memory or if they cannot fit the limit.
+ */
+static void grow(struct line_cache *restrict cache)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+struct line_cache* line_cache_create(size_t capacity) {
+    struct line_cache *cache = calloc(1, sizeof(struct line_cache));
+    if(!cache)
+        return NULL;
+
+    if(!random_key(&cache->key)) {
+        free(cache);
+        return NULL;
+    }
+
+    /* Small caches start with fewer buckets, so that the buckets alone do not exceed the limit */
+    cache->bucket_count = INITIAL_BUCKETS;
+    while(cache->bucket_count > 1 && cache->bucket_count * sizeof(struct entry *) > capacity)
+        cache->bucket_count /= 2;
+
+    cache->buckets = calloc(cache->bucket_count, sizeof(struct entry *));
+    if(!cache->buckets) {
+        free(cache);
+        return NULL;
+    }
+
+    cache->size = cache->bucket_count * sizeof(struct entry *);
+    cache->capacity = capacity;
+    return cache;
+}
+
+void line_cache_free(struct line_cache *cache) {
+    while(cache->oldest)
+        evict(cache);
+
+    free(cache->buckets);
+    free(cache);
+}
+
+bool line_cache_get(struct line_cache *cache, const char *line, size_t length,
+            const char **word, size_t *count, uint64_t *hash) {
+    *hash = hash_keyed(line, length, &cache->key);
+    struct entry *entry = find(cache, *hash, line, length);
+
+    if(!entry) {
+        cache->misses++;
+        return false;
+    }
+
+    cache->hits++;
+    unlink_lru(cache, entry);
+    link_lru(cache, entry);
+
+    *word = entry->word;
+    *count = entry->count;
+    return true;
+}
+
+void line_cache_put(struct line_cache *cache, const char *line, size_t length,
+            uint64_t hash, const char *word, size_t count) {
+    size_t word_length = word ? strlen(word) : 0;
+    size_t size = entry_size(length, word_length);
+
+    /* The entry has to fit next to the buckets, even if all the other entries are evicted */
+    size_t buckets_size = cache->bucket_count * sizeof(struct entry *);
+    if(buckets_size > cache->capacity || size > cache->capacity - buckets_size)
+        return;
+
+    /* The cache is only an optimization, so the line is simply not cached if out of memory */
+    struct entry *entry = malloc(sizeof(struct entry) + length + word_length + 1);
+    if(!entry)
+        return;
+
+    while(cache->size + size > cache->capacity)
+        evict(cache);
+
+    entry->hash = hash;
+    entry->length = length;
+    entry->word_length = word_length;
+    entry->count = count;
+    memcpy(entry->data, line, length);
+
+    if(word) {
+        memcpy(entry->data + length, word, word_length + 1);
+        entry->word = entry->data + length;
+    }
+    else
+        entry->word = NULL;
+
+    struct entry **bucket = bucket_of(cache, hash);
+    entry->chain = *bucket;
+    *bucket = entry;
+
+    link_lru(cache, entry);
+    cache->entry_count++;
+    cache->size += size;
+
+    if(cache->entry_count > cache->bucket_count)
+        grow(cache);
+}
+
+size_t line_cache_size(const struct line_cache *cache) {
+    return cache->size;
+}
+
+void line_cache_report(const struct line_cache *cache, FILE *out) {
+    size_t lookups = cache->hits + cache->misses;
+
+    fprintf(out, "Line cache: %zu hits, %zu misses (hit rate %.2f%%), %zu entries, %zu of %zu bytes used\n",
+            cache->hits, cache->misses, lookups ? 100.0 * cache->hits / lookups : 0.0,
+            cache->entry_count, cache->size, cache->capacity);
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+size_t entry_size(size_t length, size_t word_length) {
+    return sizeof(struct entry) + length + word_length + 1;
+}
+
+struct entry** bucket_of(const struct line_cache *cache, uint64_t hash) {
+    return &cache->buckets[hash & (cache->bucket_count - 1)];
+}
+
+struct entry* find(const struct line_cache *cache, uint64_t hash, const char *line, size_t length) {
+    for(struct entry *entry = *bucket_of(cache, hash); entry; entry = entry->chain)
+        if(entry->hash == hash && entry->length == length
+                && memcmp(entry->data, line, length) == 0)
+            return entry;
+
+    return NULL;
+}
+
+bool random_key(struct hash_key *key) {
+    int fd = open("/dev/urandom", O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    ssize_t result;
+    do
+        result = read(fd, key, sizeof(struct hash_key));
+    while(result < 0 && errno == EINTR);
+
+    close(fd);
+    if(result < 0)
+        return false;
+    if(result != sizeof(struct hash_key)) {
+        errno = EIO;
+        return false;
+    }
+
+    return true;
+}
+
+void unlink_lru(struct line_cache *cache, struct entry *entry) {
+    if(entry->newer)
+        entry->newer->older = entry->older;
+    else
+        cache->newest = entry->older;
+
+    if(entry->older)
+        entry->older->newer = entry->newer;
+    else
+        cache->oldest = entry->newer;
+}
+
+void link_lru(struct line_cache *cache, struct entry *entry) {
+    entry->newer = NULL;
+    entry->older = cache->newest;
+
+    if(cache->newest)
+        cache->newest->newer = entry;
+    else
+        cache->oldest = entry;
+
+    cache->newest = entry;
+}
+
+void evict(struct line_cache *cache) {
+    struct entry *entry = cache->oldest;
+    assert(entry);
+
+    struct entry **link = bucket_of(cache, entry->hash);
+    while(*link != entry)
+        link = &(*link)->chain;
+    *link = entry->chain;
+
+    unlink_lru(cache, entry);
+    cache->entry_count--;
+    cache->size -= entry_size(entry->length, entry->word_length);
+    free(entry);
+}
+
+void grow(struct line_cache *cache) {
+    /* The doubled buckets take as much memory again, the newest entry is never evicted for them */
+    size_t extra_size = cache->bucket_count * sizeof(struct entry *);
+    while(cache->size + extra_size > cache->capacity && cache->oldest != cache->newest)
+        evict(cache);
+
+    if(cache->size + extra_size > cache->capacity)
+        return;
+
+    size_t bucket_count = 2 * cache->bucket_count;
+    struct entry **buckets = calloc(bucket_count, sizeof(struct entry *));
+    if(!buckets)
+        return;
+
+    for(size_t index = 0; index < cache->bucket_count; ++index) {
+        struct entry *entry = cache->buckets[index];
+        while(entry) {
+            struct entry *next = entry->chain;
+            struct entry **bucket = &buckets[entry->hash & (bucket_count - 1)];
+            entry->chain = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = buckets;
+    cache->bucket_count = bucket_count;
+    cache->size += extra_size;
+}
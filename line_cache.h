@@ -0,0 +1,60 @@
+#ifndef _LINE_CACHE_H
+#define _LINE_CACHE_H
+
+#include "hash.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* An opaque type representing a bounded LRU cache of per-line results.
+ *
+ * Lines are addressed by a 64-bit hash of their contents, keyed by a random secret
+ * of every cache so that colliding lines cannot be chosen in advance; a hit is
+ * additionally verified against the stored copy of the line, so collisions cannot
+ * return a wrong result.
+ */
+struct line_cache;
+
+/* Creates an empty cache using at most `capacity` bytes of memory, its hash table included.
+ *
+ * Only the smallest possible hash table, a single bucket, may exceed a tiny limit.
+ * Returns NULL (with `errno` set) if out of memory or if no random key can be read.
+ */
+struct line_cache* line_cache_create(size_t capacity)
+    __attribute__((warn_unused_result));
+
+/* Frees the resources held by a cache */
+void line_cache_free(struct line_cache *restrict)
+    __attribute__((nonnull));
+
+/* Looks up the result for a line.
+ *
+ * Returns true on a hit and stores the cached word (NULL if the line has none) and its
+ * count. The word is valid until the next modification of the cache. In either case
+ * the hash of the line is stored in `hash`, to be passed to `line_cache_put` on a miss.
+ */
+bool line_cache_get(struct line_cache *restrict cache, const char *restrict line, size_t length,
+            const char **restrict word, size_t *restrict count, uint64_t *restrict hash)
+    __attribute__((nonnull));
+
+/* Stores the result for a line, evicting the least recently used entries if needed.
+ *
+ * The line must not be cached yet, and `hash` must have been computed for it by
+ * `line_cache_get`. `word` may be NULL if the line has no word counted even number
+ * of times. If out of memory, the line is not cached.
+ */
+void line_cache_put(struct line_cache *restrict cache, const char *restrict line, size_t length,
+            uint64_t hash, const char *restrict word, size_t count)
+    __attribute__((nonnull(1, 2)));
+
+/* Returns the number of bytes used by the entries and the buckets. */
+size_t line_cache_size(const struct line_cache *restrict cache)
+    __attribute__((nonnull, pure));
+
+/* Writes the hit and miss statistics to `out`. */
+void line_cache_report(const struct line_cache *restrict cache, FILE *restrict out)
+    __attribute__((nonnull));
+
+#endif /* !_LINE_CACHE_H */
@@ -1,75 +1,44 @@
 #include "run.h"
-#include "trie.h"
+#include "common.h"
 
-#include <ctype.h>
-#include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <string.h>
+#include <sys/types.h>
 
-/* State of the program */
-struct state {
-    struct unbounded_string *line;
-    struct trie *trie;
-    size_t word_begin;
-};
+/* Writes a single result to the output stream passed as `data` */
+static void print_result(const char *line, size_t line_length, const char *word, size_t count, void *data) {
+    FILE *out = data;
 
-/* Creates a new state */
-static struct state create_state(void) {
-    struct state result = {
-        .line = us_from_string(""),
-        .trie = trie_create(),
-        .word_begin = 0,
-    };
-
-    return result;
+    fwrite(line, 1, line_length, out);
+    fprintf(out, "\n%s: %zd times\n", word, count);
 }
 
-/* Cleanups an old state */
-static void cleanup_state(struct state *state) {
-    us_free(state->line);
-    trie_free(state->trie);
-}
+int run(FILE *in, FILE *out, const struct bsk_options *options) {
+    struct bsk_context *context = bsk_context_create(options, &print_result, out);
+    if(!context)
+        fail(WITH_ERRNO, "Unable to create a processing context");
 
-/* Pushses a whole word into the TRIE */
-static void push_word(struct state *state) {
-    size_t current = us_length(state->line);
-    if(state->word_begin == current)
-        return;
+    /* Whole lines are fed at once, so that interactive input is answered line by line */
+    char *buffer = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    enum bsk_status status = BSK_CONTINUE;
 
-    trie_insert(state->trie, us_to_string(state->line) + state->word_begin, current - state->word_begin);
-    state->word_begin = current + 1;
-}
+    while(status == BSK_CONTINUE && (length = getline(&buffer, &capacity, in)) > 0)
+        status = bsk_feed(context, buffer, length);
 
-int run(FILE *in, FILE *out) {
-    while(!feof(in)) {
-        struct state __attribute__((cleanup(cleanup_state))) state = create_state();
+    if(ferror(in))
+        fail(WITH_ERRNO, "Unable to read the input");
 
-        while(true) {
-            char c = getc(in);
-            if(c == '.')
-                return 0;
-            else if(c == '\n' || c == EOF)
-                break;
-            else if(isspace(c)) {
-                if(state.word_begin == us_length(state.line))
-                    ++state.word_begin;
-                else
-                    push_word(&state);
-            }
-            us_push(state.line, c);
-        }
+    if(status != BSK_ERROR)
+        status = bsk_finish(context);
+    if(status == BSK_ERROR)
+        fail(WITH_ERRNO, "Unable to process the input");
 
-        push_word(&state);
+    free(buffer);
 
-        struct trie_get_even_response response = trie_get_even(state.trie);
-        if(response.word) {
-            /* null-terminate the string */
-            us_push(state.line, 0);
-            fprintf(out, "%s\n%s: %zd times\n", us_to_string(state.line), response.word, response.count);
-            free(response.word);
-        }
-    }
+    bsk_report_stats(context, stderr);
+    bsk_context_free(context);
 
     return 0;
 }
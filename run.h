@@ -1,12 +1,16 @@
 #ifndef _RUN_H
 #define _RUN_H
 
+#include "libbsk.h"
+
 #include <stdio.h>
 
 /* Performs the taks from the problem statement.
  *
- * Reads lines from `in` and writes output to `out`.
+ * Reads lines from `in` and writes output to `out`. Statistics, if enabled
+ * in `options`, are written to stderr at exit.
  */
-int run(FILE *in, FILE *out);
+int run(FILE *in, FILE *out, const struct bsk_options *restrict options)
+    __attribute__((nonnull));
 
 #endif /* !_RUN_H */
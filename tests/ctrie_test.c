@@ -0,0 +1,145 @@
+#include "concurrent_trie.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define THREADS 8
+#define WORDS 1000
+#define ROUNDS 5
+
+/* Every thread inserts all the shared words ROUNDS times and a word of its own once */
+struct worker {
+    struct ctrie *trie;
+    unsigned id;
+    bool ok;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Writes the `index`-th shared word to `buffer`, returns its length. */
+static size_t shared_word(char *restrict buffer, size_t size, unsigned index)
+    __attribute__((nonnull));
+
+/* Writes the word owned by thread `id` to `buffer`, returns its length. */
+static size_t own_word(char *restrict buffer, size_t size, unsigned id)
+    __attribute__((nonnull));
+
+static void* work(void *worker)
+    __attribute__((nonnull));
+
+/* Reports a failed check. Always returns false. */
+static bool mismatch(const char *restrict word, size_t expected, size_t actual)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+int main(void) {
+    struct ctrie *trie = ctrie_create();
+    if(!trie) {
+        perror("ctrie_create");
+        return EXIT_FAILURE;
+    }
+
+    pthread_t threads[THREADS];
+    struct worker workers[THREADS];
+
+    for(unsigned id = 0; id < THREADS; ++id) {
+        workers[id] = (struct worker) { .trie = trie, .id = id, .ok = false };
+        if(pthread_create(&threads[id], NULL, &work, &workers[id]) != 0) {
+            perror("pthread_create");
+            return EXIT_FAILURE;
+        }
+    }
+
+    bool ok = true;
+    for(unsigned id = 0; id < THREADS; ++id) {
+        pthread_join(threads[id], NULL);
+        ok = ok && workers[id].ok;
+    }
+
+    if(!ok) {
+        fprintf(stderr, "ctrie_insert failed\n");
+        return EXIT_FAILURE;
+    }
+
+    char word[32];
+    size_t length;
+
+    for(unsigned index = 0; index < WORDS; ++index) {
+        length = shared_word(word, sizeof(word), index);
+        size_t count = ctrie_count(trie, word, length);
+        if(count != THREADS * ROUNDS)
+            ok = mismatch(word, THREADS * ROUNDS, count);
+    }
+
+    for(unsigned id = 0; id < THREADS; ++id) {
+        length = own_word(word, sizeof(word), id);
+        size_t count = ctrie_count(trie, word, length);
+        if(count != 1)
+            ok = mismatch(word, 1, count);
+    }
+
+    /* Prefixes of the inserted words exist as nodes, but have never been counted */
+    if(ctrie_count(trie, "w", 1) != 0)
+        ok = mismatch("w", 0, ctrie_count(trie, "w", 1));
+    if(ctrie_count(trie, "missing", 7) != 0)
+        ok = mismatch("missing", 0, ctrie_count(trie, "missing", 7));
+
+    /* THREADS * ROUNDS is even, so some shared word has to be found */
+    struct trie_get_even_response response = { .word = NULL, .count = 0 };
+    if(!ctrie_get_even(trie, &response) || !response.word || response.count != THREADS * ROUNDS) {
+        fprintf(stderr, "ctrie_get_even did not find a shared word\n");
+        ok = false;
+    }
+    free(response.word);
+
+    ctrie_free(trie);
+
+    if(!ok)
+        return EXIT_FAILURE;
+
+    printf("ctrie_test: %d threads, %d words, %d rounds: OK\n", THREADS, WORDS, ROUNDS);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+size_t shared_word(char *buffer, size_t size, unsigned index) {
+    return snprintf(buffer, size, "w%u", index);
+}
+
+size_t own_word(char *buffer, size_t size, unsigned id) {
+    return snprintf(buffer, size, "thread%u", id);
+}
+
+void* work(void *_worker) {
+    struct worker *worker = _worker;
+    char word[32];
+
+    worker->ok = true;
+
+    /* Every thread starts at a different word, so that the threads race on different nodes */
+    for(unsigned round = 0; round < ROUNDS; ++round)
+        for(unsigned index = 0; index < WORDS; ++index) {
+            size_t length = shared_word(word, sizeof(word), (index + worker->id * WORDS / THREADS) % WORDS);
+            worker->ok = worker->ok && ctrie_insert(worker->trie, word, length);
+        }
+
+    size_t length = own_word(word, sizeof(word), worker->id);
+    worker->ok = worker->ok && ctrie_insert(worker->trie, word, length);
+
+    return NULL;
+}
+
+bool mismatch(const char *word, size_t expected, size_t actual) {
+    fprintf(stderr, "%s: expected %zu, counted %zu\n", word, expected, actual);
+    return false;
+}
@@ -0,0 +1,181 @@
+#include "libbsk.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* How many random splits of the input are checked */
+#define SPLITS 2000
+
+/* The input: short and long lines, blank lines, a line without any even word, and the
+ * terminating dot followed by text which has to be ignored */
+static const char input[] =
+    "a a b\n"
+    "\n"
+    "x y z\n"
+    "one two two one three\n"
+    "  lead  lead  \t trailing\n"
+    "aa a aa a aaa aaa\n"
+    "\xff\xfe \xff\xfe plain\n"
+    "the quick brown fox jumps over the lazy dog end\n"
+    "last line of the stream. ignored ignored\n"
+    "ignored ignored\n";
+
+/* Collects the results of a single stream, in the format of bsk */
+struct output {
+    char *data;
+    size_t length;
+    FILE *stream;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+static void print_result(const char *restrict line, size_t line_length,
+            const char *restrict word, size_t count, void *restrict output);
+
+/* Feeds the input split at `splits` (a sorted list of `count` offsets) as a new stream.
+ *
+ * The results are collected in `output`, which has to be the callback data of the context.
+ * Returns false if the library reported an error.
+ */
+static bool feed(struct bsk_context *restrict context, const size_t *restrict splits, size_t count,
+            struct output *restrict output)
+    __attribute__((nonnull(1, 4)));
+
+/* Returns a pseudo-random number, xorshift64. */
+static uint64_t next_random(uint64_t *restrict state)
+    __attribute__((nonnull));
+
+static int compare_sizes(const void *lhs, const void *rhs)
+    __attribute__((nonnull, pure));
+
+/*
+ * =================== Public functions ===================
+ */
+
+int main(void) {
+    struct bsk_options options = { .latency = true, .slowest_lines = 3 };
+    struct output output;
+    struct bsk_context *context = bsk_context_create(&options, &print_result, &output);
+    if(!context) {
+        perror("bsk_context_create");
+        return EXIT_FAILURE;
+    }
+
+    /* The whole input at once is the reference */
+    if(!feed(context, NULL, 0, &output)) {
+        perror("bsk_feed");
+        return EXIT_FAILURE;
+    }
+    struct output expected = output;
+
+    static const char reference[] =
+        "a a b\na: 2 times\n"
+        "one two two one three\none: 2 times\n"
+        "  lead  lead  \t trailing\nlead: 2 times\n"
+        "aa a aa a aaa aaa\na: 2 times\n"
+        "\xff\xfe \xff\xfe plain\n\xff\xfe: 2 times\n"
+        "the quick brown fox jumps over the lazy dog end\nthe: 2 times\n";
+
+    bool ok = true;
+    if(expected.length != strlen(reference) || memcmp(expected.data, reference, expected.length) != 0) {
+        fprintf(stderr, "Unexpected results of the whole input:\n%.*s", (int) expected.length, expected.data);
+        ok = false;
+    }
+
+    uint64_t state = 0x9e3779b97f4a7c15u;
+    size_t length = sizeof(input) - 1;
+    size_t splits[16];
+
+    for(size_t split = 0; ok && split < SPLITS; ++split) {
+        size_t count = next_random(&state) % 16;
+        for(size_t index = 0; index < count; ++index)
+            splits[index] = next_random(&state) % (length + 1);
+        qsort(splits, count, sizeof(size_t), &compare_sizes);
+
+        if(!feed(context, splits, count, &output)) {
+            perror("bsk_feed");
+            ok = false;
+        }
+        else if(output.length != expected.length || memcmp(output.data, expected.data, expected.length) != 0) {
+            fprintf(stderr, "Split %zu: different results:\n%.*s", split, (int) output.length, output.data);
+            ok = false;
+        }
+
+        free(output.data);
+    }
+
+    /* Every stream restarts the offsets, so the slowest lines have to name their streams */
+    char *report = NULL;
+    size_t report_length = 0;
+    FILE *stream = open_memstream(&report, &report_length);
+    if(stream) {
+        bsk_report_stats(context, stream);
+        fclose(stream);
+    }
+
+    if(!report || !strstr(report, "Slowest lines:\n  stream ") || strstr(report, "\n  offset ")) {
+        fprintf(stderr, "The slowest lines do not name their streams:\n%s", report ? report : "");
+        ok = false;
+    }
+
+    free(report);
+    free(expected.data);
+    bsk_context_free(context);
+
+    if(!ok)
+        return EXIT_FAILURE;
+
+    printf("feed_test: %d random splits: OK\n", SPLITS);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+void print_result(const char *line, size_t line_length, const char *word, size_t count, void *_output) {
+    struct output *output = _output;
+
+    fwrite(line, 1, line_length, output->stream);
+    fprintf(output->stream, "\n%s: %zd times\n", word, count);
+}
+
+bool feed(struct bsk_context *context, const size_t *splits, size_t count, struct output *output) {
+    output->data = NULL;
+    output->length = 0;
+    output->stream = open_memstream(&output->data, &output->length);
+    if(!output->stream)
+        return false;
+
+    bsk_reset(context);
+
+    enum bsk_status status = BSK_CONTINUE;
+    size_t begin = 0;
+    for(size_t index = 0; index <= count && status == BSK_CONTINUE; ++index) {
+        size_t end = index < count ? splits[index] : sizeof(input) - 1;
+        status = bsk_feed(context, input + begin, end - begin);
+        begin = end;
+    }
+
+    if(status == BSK_CONTINUE)
+        status = bsk_finish(context);
+
+    fclose(output->stream);
+    return status == BSK_DONE;
+}
+
+uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+int compare_sizes(const void *_lhs, const void *_rhs) {
+    const size_t *lhs = _lhs, *rhs = _rhs;
+    return (*lhs > *rhs) - (*lhs < *rhs);
+}
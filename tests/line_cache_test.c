@@ -0,0 +1,233 @@
+#include "line_cache.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The length of the lines of the LRU and growth tests, so that all their entries have the same size */
+#define LINE_LENGTH 8
+
+/* The number of random lines of the byte cap test */
+#define RANDOM_LINES 20000
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Formats the line number `index` as a line of LINE_LENGTH characters. */
+static const char* line_of(char *restrict buffer, size_t index)
+    __attribute__((nonnull, returns_nonnull));
+
+/* Returns whether the line is cached, which also makes it the most recently used one. */
+static bool cached(struct line_cache *restrict cache, const char *restrict line, size_t length)
+    __attribute__((nonnull));
+
+/* Stores the line (without a word) if it is not cached yet. */
+static void put(struct line_cache *restrict cache, const char *restrict line, size_t length)
+    __attribute__((nonnull));
+
+/* Measures the memory used by the buckets of a fresh cache and by a single entry of LINE_LENGTH bytes.
+ *
+ * Returns false if out of memory.
+ */
+static bool measure(size_t capacity, size_t *restrict buckets_size, size_t *restrict entry_size)
+    __attribute__((nonnull));
+
+/* The least recently used line is evicted first, and a hit makes a line the most recent one. */
+static bool test_lru(void);
+
+/* Random lines and words of random lengths never make the cache exceed its limit. */
+static bool test_capacity(void);
+
+/* Doubling the buckets evicts the oldest entries to pay for the new buckets. */
+static bool test_grow(void);
+
+/* Returns a pseudo-random number, xorshift64. */
+static uint64_t next_random(uint64_t *restrict state)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+int main(void) {
+    if(!test_lru() || !test_capacity() || !test_grow())
+        return EXIT_FAILURE;
+
+    printf("line_cache_test: LRU order, byte limit, growth: OK\n");
+    return EXIT_SUCCESS;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+const char* line_of(char *buffer, size_t index) {
+    snprintf(buffer, LINE_LENGTH + 1, "line%04u", (unsigned) (index % 10000));
+    return buffer;
+}
+
+bool cached(struct line_cache *cache, const char *line, size_t length) {
+    const char *word;
+    size_t count;
+    uint64_t hash;
+    return line_cache_get(cache, line, length, &word, &count, &hash);
+}
+
+void put(struct line_cache *cache, const char *line, size_t length) {
+    const char *word;
+    size_t count;
+    uint64_t hash;
+    if(!line_cache_get(cache, line, length, &word, &count, &hash))
+        line_cache_put(cache, line, length, hash, NULL, 0);
+}
+
+bool measure(size_t capacity, size_t *buckets_size, size_t *entry_size) {
+    struct line_cache *cache = line_cache_create(capacity);
+    if(!cache) {
+        perror("line_cache_create");
+        return false;
+    }
+
+    char line[LINE_LENGTH + 1];
+    *buckets_size = line_cache_size(cache);
+    put(cache, line_of(line, 0), LINE_LENGTH);
+    *entry_size = line_cache_size(cache) - *buckets_size;
+
+    line_cache_free(cache);
+    return *entry_size > 0;
+}
+
+bool test_lru(void) {
+    size_t buckets_size, entry_size;
+    if(!measure(1 << 20, &buckets_size, &entry_size))
+        return false;
+
+    /* Room for exactly three entries */
+    struct line_cache *cache = line_cache_create(buckets_size + 3 * entry_size);
+    if(!cache) {
+        perror("line_cache_create");
+        return false;
+    }
+
+    char line[LINE_LENGTH + 1];
+    put(cache, line_of(line, 0), LINE_LENGTH);
+    put(cache, line_of(line, 1), LINE_LENGTH);
+    put(cache, line_of(line, 2), LINE_LENGTH);
+
+    /* Line 0 becomes the most recent one, so line 1 is evicted for line 3 */
+    bool ok = cached(cache, line_of(line, 0), LINE_LENGTH);
+    put(cache, line_of(line, 3), LINE_LENGTH);
+    ok = ok && !cached(cache, line_of(line, 1), LINE_LENGTH)
+        && cached(cache, line_of(line, 2), LINE_LENGTH)
+        && cached(cache, line_of(line, 0), LINE_LENGTH)
+        && cached(cache, line_of(line, 3), LINE_LENGTH);
+
+    /* The order is now 2, 0, 3 from the oldest, so line 2 goes next */
+    put(cache, line_of(line, 4), LINE_LENGTH);
+    ok = ok && !cached(cache, line_of(line, 2), LINE_LENGTH)
+        && cached(cache, line_of(line, 0), LINE_LENGTH)
+        && cached(cache, line_of(line, 3), LINE_LENGTH)
+        && cached(cache, line_of(line, 4), LINE_LENGTH)
+        && line_cache_size(cache) == buckets_size + 3 * entry_size;
+
+    if(!ok)
+        fprintf(stderr, "line_cache_test: the least recently used line is not evicted first\n");
+
+    line_cache_free(cache);
+    return ok;
+}
+
+bool test_capacity(void) {
+    static const size_t capacities[] = { 1, 100, 700, 4096, 65536 };
+    uint64_t state = 0xd1b54a32d192ed03u;
+
+    for(size_t test = 0; test < sizeof(capacities) / sizeof(capacities[0]); ++test) {
+        size_t capacity = capacities[test];
+        struct line_cache *cache = line_cache_create(capacity);
+        if(!cache) {
+            perror("line_cache_create");
+            return false;
+        }
+
+        /* Only a single bucket may exceed a tiny limit */
+        size_t limit = capacity > sizeof(void *) ? capacity : sizeof(void *);
+        bool ok = true;
+
+        for(size_t index = 0; ok && index < RANDOM_LINES; ++index) {
+            char line[256], word[64];
+            size_t length = next_random(&state) % sizeof(line);
+            for(size_t position = 0; position < length; ++position)
+                line[position] = 'a' + next_random(&state) % 4;
+
+            const char *cached_word;
+            size_t count;
+            uint64_t hash;
+            if(line_cache_get(cache, line, length, &cached_word, &count, &hash)) {
+                ok = count == length && strlen(cached_word) == length % sizeof(word);
+                if(!ok)
+                    fprintf(stderr, "line_cache_test: a wrong result is cached for a line of %zu bytes\n", length);
+                continue;
+            }
+
+            /* The word depends on the line only, so that hits can be checked */
+            memset(word, 'w', length % sizeof(word));
+            word[length % sizeof(word)] = '\0';
+            line_cache_put(cache, line, length, hash, word, length);
+
+            if(line_cache_size(cache) > limit) {
+                fprintf(stderr, "line_cache_test: %zu bytes used out of %zu\n", line_cache_size(cache), capacity);
+                ok = false;
+            }
+        }
+
+        line_cache_free(cache);
+        if(!ok)
+            return false;
+    }
+
+    return true;
+}
+
+bool test_grow(void) {
+    size_t buckets_size, entry_size;
+    if(!measure(1 << 20, &buckets_size, &entry_size))
+        return false;
+
+    /* The buckets double after one more entry than buckets, which fits with the current buckets but
+     * not with the doubled ones */
+    size_t bucket_count = buckets_size / sizeof(void *);
+    size_t capacity = buckets_size + (bucket_count + 1) * entry_size + buckets_size / 2;
+    struct line_cache *cache = line_cache_create(capacity);
+    if(!cache) {
+        perror("line_cache_create");
+        return false;
+    }
+
+    char line[LINE_LENGTH + 1];
+    for(size_t index = 0; index <= bucket_count; ++index)
+        put(cache, line_of(line, index), LINE_LENGTH);
+
+    /* The doubled buckets are paid for by the oldest entries, but the size stays in whole entries */
+    size_t size = line_cache_size(cache);
+    bool ok = size <= capacity && size > 2 * buckets_size
+        && (size - 2 * buckets_size) % entry_size == 0
+        && (size - 2 * buckets_size) / entry_size < bucket_count + 1
+        && !cached(cache, line_of(line, 0), LINE_LENGTH)
+        && cached(cache, line_of(line, bucket_count), LINE_LENGTH);
+
+    if(!ok)
+        fprintf(stderr, "line_cache_test: growing the buckets does not evict to pay for them (%zu of %zu bytes)\n",
+                size, capacity);
+
+    line_cache_free(cache);
+    return ok;
+}
+
+uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
@@ -0,0 +1,372 @@
+#include "trie.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define WORDS 20000
+#define MAX_WORD_LENGTH 6
+
+/* The layout of a snapshot, as written by `trie_save` */
+#define HEADER_SIZE 16
+#define NODE_SIZE 16
+#define VERSION_OFFSET 8
+#define COUNT_OFFSET 12
+#define FIRST_CHILD_OFFSET 8
+
+/* Few letters so that the words share prefixes, and bytes above 0x7f, which sort below them as `char` */
+static const char alphabet[] = "abc\xe9\xff";
+
+/* The words, with the first half saved into the snapshot and the second half inserted into the overlay */
+static char words[WORDS][MAX_WORD_LENGTH + 1];
+static size_t lengths[WORDS];
+
+/* A file read into memory */
+struct file {
+    char *data;
+    size_t size;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Generates the words, xorshift64. */
+static void generate(void);
+
+/* Inserts the words [begin, end) into a TRIE. */
+static bool insert(struct trie *restrict trie, size_t begin, size_t end)
+    __attribute__((nonnull));
+
+/* Maps the snapshot at `from`, inserts the words [begin, end) into it and saves it to `to`. */
+static bool extend(const char *restrict from, const char *restrict to, size_t begin, size_t end)
+    __attribute__((nonnull));
+
+static bool read_file(const char *restrict path, struct file *restrict file)
+    __attribute__((nonnull));
+
+static bool write_file(const char *restrict path, const char *restrict data, size_t size)
+    __attribute__((nonnull));
+
+/* Checks that both snapshots are the same, byte for byte. */
+static bool same_files(const char *restrict expected, const char *restrict actual, const char *restrict test)
+    __attribute__((nonnull));
+
+/* Checks that both TRIEs report the same even word. */
+static bool same_even(struct trie *restrict expected, struct trie *restrict actual)
+    __attribute__((nonnull));
+
+/* Checks that a snapshot modified by `corrupt` is rejected with EINVAL. */
+static bool rejected(const char *restrict path, const struct file *restrict snapshot, size_t size,
+            void (*corrupt)(char *restrict data), const char *restrict test)
+    __attribute__((nonnull(1, 2, 5)));
+
+/* Checks that a snapshot modified by `corrupt` maps and is usable, without reading out of bounds. */
+static bool survived(const char *restrict path, const struct file *restrict snapshot,
+            void (*corrupt)(char *restrict data), const char *restrict test)
+    __attribute__((nonnull));
+
+static void corrupt_magic(char *data)
+    __attribute__((nonnull));
+
+static void corrupt_version(char *data)
+    __attribute__((nonnull));
+
+static void corrupt_count(char *data)
+    __attribute__((nonnull));
+
+/* Points the children of the root past the end of the snapshot. */
+static void corrupt_range(char *data)
+    __attribute__((nonnull));
+
+/* Makes the root a child of itself. */
+static void corrupt_cycle(char *data)
+    __attribute__((nonnull));
+
+/* Swaps the keys of the first two children of the root. */
+static void corrupt_order(char *data)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+int main(void) {
+    char directory[] = "/tmp/bsk_trie_XXXXXX";
+    if(!mkdtemp(directory)) {
+        perror("mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    char plain_path[64], base_path[64], extended_path[64], middle_path[64], layered_path[64], scratch_path[64];
+    snprintf(plain_path, sizeof(plain_path), "%s/plain", directory);
+    snprintf(base_path, sizeof(base_path), "%s/base", directory);
+    snprintf(extended_path, sizeof(extended_path), "%s/extended", directory);
+    snprintf(middle_path, sizeof(middle_path), "%s/middle", directory);
+    snprintf(layered_path, sizeof(layered_path), "%s/layered", directory);
+    snprintf(scratch_path, sizeof(scratch_path), "%s/scratch", directory);
+
+    generate();
+
+    struct trie *plain = trie_create();
+    struct trie *base = trie_create();
+    bool ok = plain && base && insert(plain, 0, WORDS) && insert(base, 0, WORDS / 2)
+        && trie_save(plain, plain_path) && trie_save(base, base_path);
+    if(!ok)
+        perror("Unable to save the snapshots");
+    if(base)
+        trie_free(base);
+
+    /* The overlay has to give the same TRIE as inserting everything into a plain one, also over two levels */
+    ok = ok && extend(base_path, extended_path, WORDS / 2, WORDS)
+        && same_files(plain_path, extended_path, "single overlay");
+    ok = ok && extend(base_path, middle_path, WORDS / 2, WORDS * 3 / 4)
+        && extend(middle_path, layered_path, WORDS * 3 / 4, WORDS)
+        && same_files(plain_path, layered_path, "two overlays");
+
+    if(ok) {
+        struct trie *mapped = trie_open_mapped(middle_path);
+        ok = mapped && insert(mapped, WORDS * 3 / 4, WORDS) && same_even(plain, mapped);
+        if(mapped)
+            trie_free(mapped);
+    }
+
+    struct file snapshot = { .data = NULL, .size = 0 };
+    ok = ok && read_file(plain_path, &snapshot);
+
+    ok = ok && rejected(scratch_path, &snapshot, 0, NULL, "empty file")
+        && rejected(scratch_path, &snapshot, HEADER_SIZE - 1, NULL, "truncated header")
+        && rejected(scratch_path, &snapshot, snapshot.size - 1, NULL, "truncated keys")
+        && rejected(scratch_path, &snapshot, snapshot.size, &corrupt_magic, "bad magic")
+        && rejected(scratch_path, &snapshot, snapshot.size, &corrupt_version, "bad version")
+        && rejected(scratch_path, &snapshot, snapshot.size, &corrupt_count, "no nodes");
+
+    ok = ok && survived(scratch_path, &snapshot, &corrupt_range, "child range out of bounds")
+        && survived(scratch_path, &snapshot, &corrupt_cycle, "child range before its parent")
+        && survived(scratch_path, &snapshot, &corrupt_order, "keys out of order");
+
+    free(snapshot.data);
+    if(plain)
+        trie_free(plain);
+
+    unlink(plain_path);
+    unlink(base_path);
+    unlink(extended_path);
+    unlink(middle_path);
+    unlink(layered_path);
+    unlink(scratch_path);
+    rmdir(directory);
+
+    if(!ok)
+        return EXIT_FAILURE;
+
+    printf("trie_test: %d words: OK\n", WORDS);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+void generate(void) {
+    uint64_t state = 0x853c49e6748fea9bu;
+
+    for(size_t index = 0; index < WORDS; ++index) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        uint64_t random = state;
+        lengths[index] = 1 + random % MAX_WORD_LENGTH;
+        random /= MAX_WORD_LENGTH;
+
+        for(size_t position = 0; position < lengths[index]; ++position) {
+            words[index][position] = alphabet[random % (sizeof(alphabet) - 1)];
+            random /= sizeof(alphabet) - 1;
+        }
+    }
+}
+
+bool insert(struct trie *trie, size_t begin, size_t end) {
+    for(size_t index = begin; index < end; ++index) {
+        if(!trie_insert(trie, words[index], lengths[index]))
+            return false;
+    }
+
+    return true;
+}
+
+bool extend(const char *from, const char *to, size_t begin, size_t end) {
+    struct trie *trie = trie_open_mapped(from);
+    if(!trie) {
+        perror("trie_open_mapped");
+        return false;
+    }
+
+    bool ok = insert(trie, begin, end) && trie_save(trie, to);
+    if(!ok)
+        perror("Unable to extend the snapshot");
+
+    trie_free(trie);
+    return ok;
+}
+
+bool read_file(const char *path, struct file *file) {
+    FILE *stream = fopen(path, "rb");
+    if(!stream)
+        return false;
+
+    bool ok = fseek(stream, 0, SEEK_END) == 0;
+    long size = ok ? ftell(stream) : -1;
+    ok = size >= 0 && fseek(stream, 0, SEEK_SET) == 0;
+
+    file->size = ok ? (size_t) size : 0;
+    file->data = ok ? malloc(file->size + 1) : NULL;
+    ok = file->data && fread(file->data, 1, file->size, stream) == file->size;
+
+    fclose(stream);
+    return ok;
+}
+
+bool write_file(const char *path, const char *data, size_t size) {
+    FILE *stream = fopen(path, "wb");
+    if(!stream)
+        return false;
+
+    bool ok = fwrite(data, 1, size, stream) == size;
+    return fclose(stream) == 0 && ok;
+}
+
+bool same_files(const char *expected_path, const char *actual_path, const char *test) {
+    struct file expected = { .data = NULL, .size = 0 }, actual = { .data = NULL, .size = 0 };
+
+    bool ok = read_file(expected_path, &expected) && read_file(actual_path, &actual);
+    if(!ok)
+        perror("Unable to read the snapshots");
+    else if(expected.size != actual.size || memcmp(expected.data, actual.data, expected.size) != 0) {
+        fprintf(stderr, "%s: the snapshot differs from a plain TRIE (%zu bytes instead of %zu)\n",
+                test, actual.size, expected.size);
+        ok = false;
+    }
+
+    free(actual.data);
+    free(expected.data);
+    return ok;
+}
+
+bool same_even(struct trie *expected, struct trie *actual) {
+    struct trie_get_even_response expected_response, actual_response;
+    if(!trie_get_even(expected, &expected_response))
+        return false;
+    if(!trie_get_even(actual, &actual_response)) {
+        free(expected_response.word);
+        return false;
+    }
+
+    bool ok = (!expected_response.word && !actual_response.word)
+        || (expected_response.word && actual_response.word
+            && strcmp(expected_response.word, actual_response.word) == 0
+            && expected_response.count == actual_response.count);
+    if(!ok)
+        fprintf(stderr, "The mapped TRIE reports a different even word\n");
+
+    free(actual_response.word);
+    free(expected_response.word);
+    return ok;
+}
+
+bool rejected(const char *path, const struct file *snapshot, size_t size, void (*corrupt)(char *), const char *test) {
+    char *data = malloc(snapshot->size + 1);
+    if(!data)
+        return false;
+
+    memcpy(data, snapshot->data, snapshot->size);
+    if(corrupt)
+        corrupt(data);
+
+    bool ok = write_file(path, data, size);
+    free(data);
+    if(!ok) {
+        perror("Unable to write the snapshot");
+        return false;
+    }
+
+    errno = 0;
+    struct trie *trie = trie_open_mapped(path);
+    if(!trie && errno == EINVAL)
+        return true;
+
+    fprintf(stderr, "%s: the snapshot is not rejected with EINVAL\n", test);
+    if(trie)
+        trie_free(trie);
+    return false;
+}
+
+bool survived(const char *path, const struct file *snapshot, void (*corrupt)(char *), const char *test) {
+    char *data = malloc(snapshot->size);
+    if(!data)
+        return false;
+
+    memcpy(data, snapshot->data, snapshot->size);
+    corrupt(data);
+
+    bool ok = write_file(path, data, snapshot->size);
+    free(data);
+    if(!ok) {
+        perror("Unable to write the snapshot");
+        return false;
+    }
+
+    /* The results are meaningless, but the TRIE has to stay usable */
+    struct trie *trie = trie_open_mapped(path);
+    struct trie_get_even_response response = { .word = NULL, .count = 0 };
+    ok = trie && insert(trie, 0, WORDS / 10) && trie_get_even(trie, &response) && trie_save(trie, path);
+    if(!ok)
+        fprintf(stderr, "%s: the snapshot is not usable: %s\n", test, strerror(errno));
+
+    free(response.word);
+    if(trie)
+        trie_free(trie);
+    return ok;
+}
+
+void corrupt_magic(char *data) {
+    data[0] ^= 1;
+}
+
+void corrupt_version(char *data) {
+    uint32_t version;
+    memcpy(&version, data + VERSION_OFFSET, sizeof(version));
+    version++;
+    memcpy(data + VERSION_OFFSET, &version, sizeof(version));
+}
+
+void corrupt_count(char *data) {
+    memset(data + COUNT_OFFSET, 0, sizeof(uint32_t));
+}
+
+void corrupt_range(char *data) {
+    /* Far enough to fault, but without wrapping around at the end of the range */
+    uint32_t child_count, first_child;
+    memcpy(&child_count, data + HEADER_SIZE + FIRST_CHILD_OFFSET + sizeof(uint32_t), sizeof(child_count));
+    first_child = UINT32_MAX - child_count - 1;
+    memcpy(data + HEADER_SIZE + FIRST_CHILD_OFFSET, &first_child, sizeof(first_child));
+}
+
+void corrupt_cycle(char *data) {
+    memset(data + HEADER_SIZE + FIRST_CHILD_OFFSET, 0, sizeof(uint32_t));
+}
+
+void corrupt_order(char *data) {
+    uint32_t node_count, first_child;
+    memcpy(&node_count, data + COUNT_OFFSET, sizeof(node_count));
+    memcpy(&first_child, data + HEADER_SIZE + FIRST_CHILD_OFFSET, sizeof(first_child));
+
+    char *keys = data + HEADER_SIZE + (size_t) node_count * NODE_SIZE;
+    char key = keys[first_child];
+    keys[first_child] = keys[first_child + 1];
+    keys[first_child + 1] = key;
+}
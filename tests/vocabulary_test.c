@@ -0,0 +1,186 @@
+#include "libbsk.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define LINES 20000
+#define MAX_WORDS_PER_LINE 12
+
+/* Prefixes of each other and bytes above 0x7f, where the order of the words matters */
+static const char *const words[] = {
+    "a", "aa", "aab", "ab", "b", "ba", "\xe9t\xe9", "\xe9", "\xff", "\xff\x01", "z", "zz",
+};
+#define WORD_COUNT (sizeof(words) / sizeof(words[0]))
+
+/* Only the first FILTERED_COUNT words are in the smaller vocabulary */
+#define FILTERED_COUNT 7
+
+/* The result reported for the last line */
+struct result {
+    bool found;
+    char word[16];
+    size_t count;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+static void store_result(const char *restrict line, size_t line_length,
+            const char *restrict word, size_t count, void *restrict result);
+
+/* Writes the first `count` words into a temporary file, returns its path in `path`. */
+static bool write_vocabulary(char *restrict path, size_t count)
+    __attribute__((nonnull));
+
+/* Processes a single line as a new stream, the result is stored by the callback. */
+static bool process(struct bsk_context *restrict context, const char *restrict line, size_t length)
+    __attribute__((nonnull));
+
+/* Returns a pseudo-random number, xorshift64. */
+static uint64_t next_random(uint64_t *restrict state)
+    __attribute__((nonnull));
+
+/* Checks that both results are the same, reports the line if they are not. */
+static bool same(const struct result *restrict expected, const struct result *restrict actual,
+            const char *restrict mode, const char *restrict line)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+int main(void) {
+    char full_path[] = "/tmp/bsk_vocabulary_XXXXXX", filtered_path[] = "/tmp/bsk_vocabulary_XXXXXX";
+    if(!write_vocabulary(full_path, WORD_COUNT) || !write_vocabulary(filtered_path, FILTERED_COUNT)) {
+        perror("Unable to write a vocabulary");
+        return EXIT_FAILURE;
+    }
+
+    struct bsk_vocabulary *full = bsk_vocabulary_load(full_path);
+    struct bsk_vocabulary *filtered = bsk_vocabulary_load(filtered_path);
+    unlink(full_path);
+    unlink(filtered_path);
+    if(!full || !filtered) {
+        perror("bsk_vocabulary_load");
+        return EXIT_FAILURE;
+    }
+
+    struct result plain_result, full_result, filtered_result, reference_result;
+    struct bsk_options plain_options = { .vocabulary = NULL };
+    struct bsk_options full_options = { .vocabulary = full };
+    struct bsk_options filtered_options = { .vocabulary = filtered };
+
+    struct bsk_context *plain = bsk_context_create(&plain_options, &store_result, &plain_result);
+    struct bsk_context *full_context = bsk_context_create(&full_options, &store_result, &full_result);
+    struct bsk_context *filtered_context = bsk_context_create(&filtered_options, &store_result, &filtered_result);
+    struct bsk_context *reference = bsk_context_create(&plain_options, &store_result, &reference_result);
+    if(!plain || !full_context || !filtered_context || !reference) {
+        perror("bsk_context_create");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t state = 0x2545f4914f6cdd1du;
+    bool ok = true;
+
+    for(size_t line_index = 0; ok && line_index < LINES; ++line_index) {
+        char line[MAX_WORDS_PER_LINE * 8], kept[MAX_WORDS_PER_LINE * 8];
+        size_t length = 0, kept_length = 0;
+
+        size_t count = 1 + next_random(&state) % MAX_WORDS_PER_LINE;
+        for(size_t index = 0; index < count; ++index) {
+            size_t word = next_random(&state) % WORD_COUNT;
+            length += sprintf(line + length, "%s ", words[word]);
+            if(word < FILTERED_COUNT)
+                kept_length += sprintf(kept + kept_length, "%s ", words[word]);
+        }
+
+        plain_result.found = full_result.found = filtered_result.found = reference_result.found = false;
+        ok = process(plain, line, length) && process(full_context, line, length)
+            && process(filtered_context, line, length) && process(reference, kept, kept_length);
+        if(!ok) {
+            perror("bsk_feed");
+            break;
+        }
+
+        /* A vocabulary covering the whole line changes nothing, a smaller one only drops the other words */
+        ok = same(&plain_result, &full_result, "full vocabulary", line)
+            && same(&reference_result, &filtered_result, "filtered vocabulary", line);
+    }
+
+    bsk_context_free(reference);
+    bsk_context_free(filtered_context);
+    bsk_context_free(full_context);
+    bsk_context_free(plain);
+    bsk_vocabulary_free(filtered);
+    bsk_vocabulary_free(full);
+
+    if(!ok)
+        return EXIT_FAILURE;
+
+    printf("vocabulary_test: %d lines: OK\n", LINES);
+    return EXIT_SUCCESS;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+void store_result(const char *line, size_t line_length, const char *word, size_t count, void *_result) {
+    struct result *result = _result;
+    (void) line;
+    (void) line_length;
+
+    result->found = true;
+    snprintf(result->word, sizeof(result->word), "%s", word);
+    result->count = count;
+}
+
+bool write_vocabulary(char *path, size_t count) {
+    int fd = mkstemp(path);
+    if(fd < 0)
+        return false;
+
+    FILE *file = fdopen(fd, "w");
+    if(!file) {
+        close(fd);
+        return false;
+    }
+
+    /* Duplicates have to be ignored */
+    for(size_t index = 0; index < count; ++index)
+        fprintf(file, "%s\n%s\t", words[index], words[count - 1 - index]);
+
+    return fclose(file) == 0;
+}
+
+bool process(struct bsk_context *context, const char *line, size_t length) {
+    bsk_reset(context);
+
+    enum bsk_status status = bsk_feed(context, line, length);
+    if(status == BSK_CONTINUE)
+        status = bsk_finish(context);
+
+    return status == BSK_DONE;
+}
+
+uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+bool same(const struct result *expected, const struct result *actual, const char *mode, const char *line) {
+    if(expected->found == actual->found
+            && (!expected->found || (strcmp(expected->word, actual->word) == 0 && expected->count == actual->count)))
+        return true;
+
+    fprintf(stderr, "%s: different results for the line \"%s\": %s (%zu) instead of %s (%zu)\n", mode, line,
+            actual->found ? actual->word : "none", actual->count,
+            expected->found ? expected->word : "none", expected->count);
+    return false;
+}
@@ -1,154 +1,659 @@
 #include "trie.h"
-#include "common.h"
-#include "rbt.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-/* Represents a node in a TRIE */
-struct trie_node {
-    /* A map (char -> trie_node) of the children of the current node. */
-    struct rb_tree *children;
+#define SNAPSHOT_MAGIC "BSKTRIE"
+#define SNAPSHOT_VERSION 1
 
+/* The handle of the root node */
+#define ROOT 0
+
+/* Marks an absent node (e.g. the end of a sibling list) */
+#define NO_NODE UINT32_MAX
+
+/* Marks a TRIE node without a counterpart in the mapped snapshot */
+#define NO_BASE UINT32_MAX
+
+#define INITIAL_CAPACITY 16
+
+/* The header of a snapshot file.
+ *
+ * It is followed by `node_count` snapshot_nodes in BFS order (so the children of every
+ * node are stored contiguously, sorted by key as `char`) and then by `node_count` keys: the
+ * characters on the edges leading to the respective nodes. All integers are stored
+ * in the native byte order.
+ */
+struct snapshot_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t node_count;
+};
+
+/* A node in a snapshot file */
+struct snapshot_node {
     /* A counter indicating how many words end in this node. */
-    size_t counter;
+    uint64_t counter;
+
+    /* The index of the first child, relative to the index of this node. */
+    uint32_t first_child;
+
+    /* The number of children. */
+    uint32_t child_count;
 };
 
+/* A TRIE stored as a structure of arrays.
+ *
+ * Nodes are addressed by 32-bit handles indexing the arrays below. The children
+ * of a node form a sibling list sorted by key, compared as `char` like the red-black
+ * trees used to, so the reported words do not depend on the layout.
+ */
 struct trie {
-    struct trie_node *root;
+    /* The first child of every node, NO_NODE if none. */
+    uint32_t *first_child;
+
+    /* The next sibling (with a greater key) of every node, NO_NODE if none. */
+    uint32_t *next_sibling;
+
+    /* The character on the edge leading to every node. */
+    char *keys;
+
+    /* How many words end in every node. */
+    size_t *counters;
+
+    /* The corresponding node of the mapped snapshot, NULL if there is no snapshot. */
+    uint32_t *bases;
+
+    /* The number of used and allocated nodes. */
+    uint32_t count, capacity;
+
+    /* The mapped snapshot, NULL if none. */
+    void *mapping;
+    size_t mapping_size;
+
+    /* The nodes and the keys of the mapped snapshot, and the number of its nodes. */
+    const struct snapshot_node *base_nodes;
+    const char *base_keys;
+    uint32_t base_count;
+};
+
+/* The nodes of a snapshot being built, in the output order */
+struct snapshot_builder {
+    /* The BFS queue of (node, base) pairs doubles as the list of nodes in the output order */
+    uint32_t *queue_nodes, *queue_bases;
+    char *keys;
+    struct snapshot_node *nodes;
+
+    /* The number of used and allocated nodes. */
+    size_t count, capacity;
+};
+
+/* Iterates over the children of a node, seen through the copy-on-write overlay */
+struct child_cursor {
+    /* The next child in the overlay, NO_NODE if none */
+    uint32_t node;
+
+    /* The range of snapshot children and the next one of them */
+    uint32_t base_begin, base, base_end;
 };
 
 /*
  * =================== Private interface ===================
  */
 
-/* Creates a TRIE node. */
-static struct trie_node* node_create()
-    __attribute__((returns_nonnull));
+/* Allocates a TRIE with just the root node, on top of the snapshot `mapping`, if any.
+ *
+ * Returns NULL if out of memory, the mapping is not taken over then.
+ */
+static struct trie* trie_alloc(void *mapping, size_t mapping_size);
+
+/* Doubles the capacity of a TRIE. Returns false if out of memory. */
+static bool grow(struct trie *restrict trie)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Appends a node corresponding to the snapshot node `base` and returns its handle.
+ *
+ * Returns NO_NODE if out of memory.
+ */
+static uint32_t node_create(struct trie *restrict trie, char key, uint32_t base)
+    __attribute__((nonnull));
+
+/* Shrinks an array to `size` bytes. Returns the original array if that fails. */
+static void* shrink(void *restrict array, size_t size)
+    __attribute__((nonnull, returns_nonnull));
+
+/* Returns the corresponding snapshot node, NO_BASE if none. */
+static inline uint32_t node_base(const struct trie *restrict trie, uint32_t node)
+    __attribute__((nonnull, pure));
+
+/* Returns the child of `node` with the given key, creating it if needed. Returns NO_NODE if out of memory. */
+static uint32_t node_child(struct trie *restrict trie, uint32_t node, char key)
+    __attribute__((nonnull));
+
+/* Finds the range [begin, end) of the children of the snapshot node `base`.
+ *
+ * Returns false if there are none. A range which does not lie within the snapshot or does not
+ * start after its parent (so that every path ends) is malformed and treated as empty.
+ */
+static bool base_children(const struct trie *restrict trie, uint32_t base, uint32_t *restrict begin, uint32_t *restrict end)
+    __attribute__((nonnull));
+
+/* Finds the child of the snapshot node `base` with the given key. Returns NO_BASE if none. */
+static uint32_t base_find_child(const struct trie *restrict trie, uint32_t base, char key)
+    __attribute__((nonnull, pure));
+
+/* Starts iterating over the children of the (`node`, `base`) pair. Either of them may be absent. */
+static struct child_cursor cursor_create(const struct trie *restrict trie, uint32_t node, uint32_t base)
+    __attribute__((nonnull));
+
+/* Fetches the next child in key order. Returns false if there are no more children. */
+static bool cursor_next(const struct trie *restrict trie, struct child_cursor *restrict cursor,
+            char *restrict key, uint32_t *restrict node, uint32_t *restrict base)
+    __attribute__((nonnull));
 
-/* Deletes a TRIE node recursively. */
-static void node_free_recursively(struct trie_node *restrict node);
+/* Lays out the nodes of a TRIE in BFS order. Returns false on failure. */
+static bool snapshot_build(const struct trie *restrict trie, struct snapshot_builder *restrict builder)
+    __attribute__((nonnull, warn_unused_result));
 
-/* A value destructor for the red-black trees. */
-static void rb_value_destructor(const struct rb_tree *restrict tree, rb_key key, void *restrict value, void *restrict data)
-    __attribute__((nonnull(1, 3)));
+/* Makes room for one more node in a snapshot being built. Returns false if out of memory. */
+static bool snapshot_reserve(struct snapshot_builder *restrict builder)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Frees the memory held by a snapshot being built. */
+static void snapshot_free(struct snapshot_builder *restrict builder)
+    __attribute__((nonnull));
 
 struct trie_get_even_data {
+    const struct trie *trie;
     struct unbounded_string *current;
     struct trie_get_even_response result;
+
+    /* Set if the search ran out of memory */
+    bool failed;
 };
 
-static void node_get_even(const struct trie_node *restrict node, struct trie_get_even_data *restrict data)
+/* Searches the subtree of the (`node`, `base`) pair. Either of them may be absent. */
+static void node_get_even(uint32_t node, uint32_t base, struct trie_get_even_data *restrict data)
     __attribute__((nonnull));
 
-static void node_get_even_foreach_callback(const struct rb_tree *restrict tree, rb_key key, void *restrict value, void *restrict data)
-    __attribute__((nonnull(1, 3)));
-
-/* 
+/*
  * =================== Public functions ===================
  */
 
 struct trie* trie_create(void) {
-    struct trie *trie = calloc(1, sizeof(struct trie));
+    return trie_alloc(NULL, 0);
+}
 
-    if(!trie)
-        fail(WITH_ERRNO, "Unable to allocate memory for a TRIE");
+struct trie* trie_open_mapped(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0)
+        return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        int error = errno;
+        close(fd);
+        errno = error;
+        return NULL;
+    }
 
-    trie->root = node_create();
+    size_t size = st.st_size;
+    if(size < sizeof(struct snapshot_header)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        errno = error;
+        return NULL;
+    }
+
+    /* Only the header is checked, so that opening does not touch the nodes. They are
+     * checked where they are used, see `base_children` and `cursor_next`. */
+    const struct snapshot_header *header = mapping;
+    if(memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0
+            || header->version != SNAPSHOT_VERSION
+            || header->node_count == 0
+            || size != sizeof(struct snapshot_header) + (size_t) header->node_count * (sizeof(struct snapshot_node) + 1)) {
+        munmap(mapping, size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    struct trie *trie = trie_alloc(mapping, size);
+    if(!trie) {
+        munmap(mapping, size);
+        errno = ENOMEM;
+    }
 
     return trie;
 }
 
 void trie_free(struct trie *trie) {
-    node_free_recursively(trie->root);
+    if(trie->mapping)
+        munmap(trie->mapping, trie->mapping_size);
+
+    free(trie->first_child);
+    free(trie->next_sibling);
+    free(trie->keys);
+    free(trie->counters);
+    free(trie->bases);
     free(trie);
 }
 
-void trie_insert(struct trie *trie, const char *word, size_t length) {
-    struct trie_node *node = trie->root;
+void trie_clear(struct trie *trie) {
+    trie->count = 0;
 
-    for(size_t index = 0; index < length; ++index) {
-        struct trie_node *next = rb_get(node->children, word[index]);
+    /* The capacity never drops to zero, so creating the root cannot fail */
+    uint32_t root = node_create(trie, 0, trie->mapping ? 0 : NO_BASE);
+    assert(root == ROOT);
+    (void) root;
+}
 
-        if(!next) {
-            next = node_create();
-            rb_insert(node->children, word[index], next);
-        }
+void trie_trim(struct trie *trie, size_t high_water) {
+    size_t capacity = trie->count > high_water ? trie->count : high_water;
+    if(capacity < INITIAL_CAPACITY)
+        capacity = INITIAL_CAPACITY;
+    if(trie->capacity <= capacity)
+        return;
+
+    /* Shrinking never moves the contents, so arrays that could not be shrunk stay valid */
+    trie->first_child = shrink(trie->first_child, capacity * sizeof(uint32_t));
+    trie->next_sibling = shrink(trie->next_sibling, capacity * sizeof(uint32_t));
+    trie->keys = shrink(trie->keys, capacity);
+    trie->counters = shrink(trie->counters, capacity * sizeof(size_t));
+    if(trie->bases)
+        trie->bases = shrink(trie->bases, capacity * sizeof(uint32_t));
+
+    trie->capacity = capacity;
+}
+
+bool trie_save(const struct trie *trie, const char *path) {
+    struct snapshot_builder builder = { 0 };
+    if(!snapshot_build(trie, &builder)) {
+        snapshot_free(&builder);
+        return false;
+    }
+
+    struct snapshot_header header = {
+        .magic = SNAPSHOT_MAGIC,
+        .version = SNAPSHOT_VERSION,
+        .node_count = builder.count,
+    };
 
-        node = next;
+    FILE *file = fopen(path, "wb");
+    if(!file) {
+        snapshot_free(&builder);
+        return false;
     }
 
-    node->counter++;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(builder.nodes, sizeof(struct snapshot_node), builder.count, file) == builder.count
+        && fwrite(builder.keys, 1, builder.count, file) == builder.count;
+
+    if(fclose(file) != 0)
+        ok = false;
+
+    snapshot_free(&builder);
+    return ok;
 }
 
-struct trie_get_even_response trie_get_even(struct trie *trie) {
+bool trie_insert(struct trie *trie, const char *word, size_t length) {
+    uint32_t node = ROOT;
+
+    for(size_t index = 0; index < length; ++index) {
+        node = node_child(trie, node, word[index]);
+        if(node == NO_NODE)
+            return false;
+    }
+
+    trie->counters[node]++;
+    return true;
+}
+
+bool trie_get_even(struct trie *trie, struct trie_get_even_response *response) {
     struct trie_get_even_data data = {
+        .trie = trie,
         .current = us_from_string(""),
         .result = {
             .word = NULL,
             .count = 0
-        }
+        },
+        .failed = false
     };
 
-    node_get_even(trie->root, &data);
+    if(!data.current)
+        return false;
+
+    node_get_even(ROOT, node_base(trie, ROOT), &data);
 
     us_free(data.current);
-    return data.result;
+    *response = data.result;
+    return !data.failed;
 }
 
-/* 
+/*
  * =================== Private functions ===================
  */
 
+struct trie* trie_alloc(void *mapping, size_t mapping_size) {
+    struct trie *trie = calloc(1, sizeof(struct trie));
+    if(!trie)
+        return NULL;
+
+    trie->capacity = INITIAL_CAPACITY;
+    trie->first_child = malloc(trie->capacity * sizeof(uint32_t));
+    trie->next_sibling = malloc(trie->capacity * sizeof(uint32_t));
+    trie->keys = malloc(trie->capacity);
+    trie->counters = malloc(trie->capacity * sizeof(size_t));
+    if(mapping)
+        trie->bases = malloc(trie->capacity * sizeof(uint32_t));
+
+    if(!trie->first_child || !trie->next_sibling || !trie->keys || !trie->counters || (mapping && !trie->bases)) {
+        trie_free(trie);
+        return NULL;
+    }
+
+    if(mapping) {
+        const struct snapshot_header *header = mapping;
 
-struct trie_node* node_create() {
-    struct trie_node *node = calloc(1, sizeof(struct trie_node));
-    if(!node)
-        fail(WITH_ERRNO, "Unable to allocate memory for a TRIE node");
+        trie->mapping = mapping;
+        trie->mapping_size = mapping_size;
+        trie->base_nodes = (const struct snapshot_node *) (header + 1);
+        trie->base_keys = (const char *) (trie->base_nodes + header->node_count);
+        trie->base_count = header->node_count;
+    }
 
-    node->children = rb_tree_create();
-    rb_set_value_destructor(node->children, &rb_value_destructor, NULL);
+    trie_clear(trie);
+    return trie;
+}
+
+bool grow(struct trie *trie) {
+    if(trie->capacity >= NO_NODE / 2) {
+        errno = ENOMEM;
+        return false;
+    }
+
+    /* Every array is replaced as soon as it has been reallocated, so the TRIE stays valid on failure */
+    uint32_t capacity = 2 * trie->capacity;
+
+    uint32_t *first_child = realloc(trie->first_child, capacity * sizeof(uint32_t));
+    if(!first_child)
+        return false;
+    trie->first_child = first_child;
+
+    uint32_t *next_sibling = realloc(trie->next_sibling, capacity * sizeof(uint32_t));
+    if(!next_sibling)
+        return false;
+    trie->next_sibling = next_sibling;
+
+    char *keys = realloc(trie->keys, capacity);
+    if(!keys)
+        return false;
+    trie->keys = keys;
+
+    size_t *counters = realloc(trie->counters, capacity * sizeof(size_t));
+    if(!counters)
+        return false;
+    trie->counters = counters;
+
+    if(trie->bases) {
+        uint32_t *bases = realloc(trie->bases, capacity * sizeof(uint32_t));
+        if(!bases)
+            return false;
+        trie->bases = bases;
+    }
+
+    trie->capacity = capacity;
+    return true;
+}
+
+uint32_t node_create(struct trie *trie, char key, uint32_t base) {
+    if(trie->count == trie->capacity && !grow(trie))
+        return NO_NODE;
+
+    uint32_t node = trie->count++;
+    trie->first_child[node] = NO_NODE;
+    trie->next_sibling[node] = NO_NODE;
+    trie->keys[node] = key;
+
+    /* Copy on write: the overlay node starts with the counter from the snapshot */
+    trie->counters[node] = base != NO_BASE ? trie->base_nodes[base].counter : 0;
+    if(trie->bases)
+        trie->bases[node] = base;
 
     return node;
 }
 
-void node_free_recursively(struct trie_node *node) {
-    if(!node)
-        return;
+void* shrink(void *array, size_t size) {
+    void *shrunk = realloc(array, size);
+    return shrunk ? shrunk : array;
+}
 
-    rb_tree_free(node->children);
-    free(node);
+uint32_t node_base(const struct trie *trie, uint32_t node) {
+    return trie->bases ? trie->bases[node] : NO_BASE;
 }
 
-void rb_value_destructor(const struct rb_tree *tree __attribute__((unused)),
-        rb_key key __attribute__((unused)),
-        void *value,
-        void *data __attribute__((unused))) {
-    node_free_recursively((struct trie_node *) value);
+uint32_t node_child(struct trie *trie, uint32_t node, char key) {
+    uint32_t prev = NO_NODE, child = trie->first_child[node];
+
+    while(child != NO_NODE && trie->keys[child] < key) {
+        prev = child;
+        child = trie->next_sibling[child];
+    }
+
+    if(child != NO_NODE && trie->keys[child] == key)
+        return child;
+
+    uint32_t base = node_base(trie, node);
+    uint32_t fresh = node_create(trie, key, base == NO_BASE ? NO_BASE : base_find_child(trie, base, key));
+    if(fresh == NO_NODE)
+        return NO_NODE;
+
+    trie->next_sibling[fresh] = child;
+    if(prev == NO_NODE)
+        trie->first_child[node] = fresh;
+    else
+        trie->next_sibling[prev] = fresh;
+
+    return fresh;
 }
 
-void node_get_even(const struct trie_node *node, struct trie_get_even_data *data) {
-    if(node->counter > 0 && node->counter % 2 == 0 && !data->result.word) {
-        data->result.count = node->counter;
-        data->result.word = strndup(us_to_string(data->current), us_length(data->current));
-        if(!data->result.word) {
-            fail(WITH_ERRNO, "Unable to copy a string");
-        }
+bool base_children(const struct trie *trie, uint32_t base, uint32_t *begin, uint32_t *end) {
+    const struct snapshot_node *node = &trie->base_nodes[base];
+    uint64_t first = (uint64_t) base + node->first_child, last = first + node->child_count;
+
+    if(node->child_count == 0 || node->first_child == 0 || last > trie->base_count)
+        return false;
+
+    *begin = first;
+    *end = last;
+    return true;
+}
+
+uint32_t base_find_child(const struct trie *trie, uint32_t base, char key) {
+    uint32_t begin, end;
+    if(!base_children(trie, base, &begin, &end))
+        return NO_BASE;
+
+    uint32_t low = begin, high = end;
+    while(low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if(trie->base_keys[middle] < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    /* Keys out of order make the search unreliable, such a match is not trusted */
+    if(low < end && trie->base_keys[low] == key
+            && (low == begin || trie->base_keys[low - 1] < key)
+            && (low + 1 == end || trie->base_keys[low + 1] > key))
+        return low;
+
+    return NO_BASE;
+}
+
+struct child_cursor cursor_create(const struct trie *trie, uint32_t node, uint32_t base) {
+    struct child_cursor cursor = {
+        .node = node != NO_NODE ? trie->first_child[node] : NO_NODE,
+        .base_begin = 0,
+        .base = 0,
+        .base_end = 0,
+    };
+
+    if(base != NO_BASE && base_children(trie, base, &cursor.base_begin, &cursor.base_end))
+        cursor.base = cursor.base_begin;
+
+    return cursor;
+}
+
+bool cursor_next(const struct trie *trie, struct child_cursor *cursor, char *key, uint32_t *node, uint32_t *base) {
+    /* A snapshot key out of order ends the range, the rest of a malformed range is ignored */
+    if(cursor->base < cursor->base_end && cursor->base > cursor->base_begin
+            && trie->base_keys[cursor->base] <= trie->base_keys[cursor->base - 1])
+        cursor->base_end = cursor->base;
+
+    bool has_node = cursor->node != NO_NODE, has_base = cursor->base < cursor->base_end;
+
+    if(!has_node && !has_base)
+        return false;
+
+    if(has_node && (!has_base || trie->keys[cursor->node] <= trie->base_keys[cursor->base])) {
+        *key = trie->keys[cursor->node];
+        *node = cursor->node;
+        *base = node_base(trie, cursor->node);
+        cursor->node = trie->next_sibling[cursor->node];
+
+        /* The overlay node shadows the snapshot one with the same key */
+        if(has_base && *key == trie->base_keys[cursor->base])
+            cursor->base++;
     }
+    else {
+        *key = trie->base_keys[cursor->base];
+        *node = NO_NODE;
+        *base = cursor->base++;
+    }
+
+    return true;
+}
+
+bool snapshot_build(const struct trie *trie, struct snapshot_builder *builder) {
+    if(!snapshot_reserve(builder))
+        return false;
+
+    builder->queue_nodes[0] = ROOT;
+    builder->queue_bases[0] = node_base(trie, ROOT);
+    builder->keys[0] = 0;
+    builder->count = 1;
+
+    for(size_t index = 0; index < builder->count; ++index) {
+        uint32_t node = builder->queue_nodes[index], base = builder->queue_bases[index];
+        size_t first_child = builder->count;
+
+        struct child_cursor cursor = cursor_create(trie, node, base);
+        char key;
+        uint32_t child, child_base;
+
+        while(cursor_next(trie, &cursor, &key, &child, &child_base)) {
+            if(builder->count + 1 >= NO_BASE) {
+                errno = EOVERFLOW;
+                return false;
+            }
+
+            if(!snapshot_reserve(builder))
+                return false;
+
+            builder->queue_nodes[builder->count] = child;
+            builder->queue_bases[builder->count] = child_base;
+            builder->keys[builder->count] = key;
+            builder->count++;
+        }
 
-    if(!data->result.word) {
-        rb_foreach(node->children, &node_get_even_foreach_callback, data);
+        builder->nodes[index] = (struct snapshot_node) {
+            .counter = node != NO_NODE ? trie->counters[node] : trie->base_nodes[base].counter,
+            .first_child = builder->count > first_child ? first_child - index : 0,
+            .child_count = builder->count - first_child,
+        };
     }
+
+    return true;
+}
+
+bool snapshot_reserve(struct snapshot_builder *builder) {
+    if(builder->count < builder->capacity)
+        return true;
+
+    /* Every array is replaced as soon as it has been reallocated, so snapshot_free releases them all */
+    size_t capacity = builder->capacity ? 2 * builder->capacity : INITIAL_CAPACITY;
+
+    uint32_t *queue_nodes = realloc(builder->queue_nodes, capacity * sizeof(uint32_t));
+    if(!queue_nodes)
+        return false;
+    builder->queue_nodes = queue_nodes;
+
+    uint32_t *queue_bases = realloc(builder->queue_bases, capacity * sizeof(uint32_t));
+    if(!queue_bases)
+        return false;
+    builder->queue_bases = queue_bases;
+
+    char *keys = realloc(builder->keys, capacity);
+    if(!keys)
+        return false;
+    builder->keys = keys;
+
+    struct snapshot_node *nodes = realloc(builder->nodes, capacity * sizeof(struct snapshot_node));
+    if(!nodes)
+        return false;
+    builder->nodes = nodes;
+
+    builder->capacity = capacity;
+    return true;
 }
 
-void node_get_even_foreach_callback(const struct rb_tree *tree __attribute__((unused)),
-        rb_key key, void *_node, void *_data) {
-    struct trie_get_even_data *data = _data;
-    const struct trie_node *node = _node;
+void snapshot_free(struct snapshot_builder *builder) {
+    free(builder->nodes);
+    free(builder->keys);
+    free(builder->queue_bases);
+    free(builder->queue_nodes);
+}
 
-    us_push(data->current, key);
-    node_get_even(node, data);
-    us_pop(data->current);
+void node_get_even(uint32_t node, uint32_t base, struct trie_get_even_data *data) {
+    const struct trie *trie = data->trie;
+    size_t counter = node != NO_NODE ? trie->counters[node] : trie->base_nodes[base].counter;
+
+    if(counter > 0 && counter % 2 == 0) {
+        data->result.count = counter;
+        data->result.word = strndup(us_to_string(data->current), us_length(data->current));
+        if(!data->result.word)
+            data->failed = true;
+        return;
+    }
+
+    struct child_cursor cursor = cursor_create(trie, node, base);
+    char key;
+    uint32_t child, child_base;
+
+    while(!data->result.word && !data->failed && cursor_next(trie, &cursor, &key, &child, &child_base)) {
+        if(!us_push(data->current, key)) {
+            data->failed = true;
+            return;
+        }
+
+        node_get_even(child, child_base, data);
+        us_pop(data->current);
+    }
 }
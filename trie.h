@@ -3,22 +3,62 @@
 
 #include "unbounded_string.h"
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /* An opaque type representing a TRIE */
 struct trie;
 
-/* Creates a new, empty TRIE */
+/* Creates a new, empty TRIE. Returns NULL if out of memory. */
 struct trie* trie_create(void)
-    __attribute__((returns_nonnull));
+    __attribute__((warn_unused_result));
 
 /* Frees the resources held by a TRIE */
 void trie_free(struct trie *restrict)
     __attribute__((nonnull));
 
-/* Inserts a word into a TRIE */
-void trie_insert(struct trie *restrict tree, const char *restrict word, size_t length)
-    __attribute__((nonnull(1, 2)));
+/* Removes all the words from a TRIE, keeping the allocated memory for reuse.
+ *
+ * A mapped TRIE is reset to the contents of its snapshot.
+ */
+void trie_clear(struct trie *restrict)
+    __attribute__((nonnull));
+
+/* Releases the memory held by a TRIE above `high_water` nodes (or its size, if larger).
+ *
+ * Meant to be called after `trie_clear` following an unusually large TRIE, so that
+ * a single outlier does not pin its memory forever.
+ */
+void trie_trim(struct trie *restrict, size_t high_water)
+    __attribute__((nonnull));
+
+/* Writes a snapshot of a TRIE to the file `path`.
+ *
+ * The snapshot is pointer-free and can be mapped back with `trie_open_mapped`.
+ * Returns false (with `errno` set) on failure.
+ */
+bool trie_save(const struct trie *restrict, const char *restrict path)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Maps a snapshot written by `trie_save` into memory.
+ *
+ * The file is not parsed, so the TRIE is queryable immediately. Words inserted
+ * into it are kept in a private copy-on-write overlay; the file is never modified.
+ *
+ * Only the header and the size are checked here. The nodes are checked as they are
+ * used: a malformed snapshot gives wrong counts, but is never read out of bounds.
+ *
+ * Returns NULL (with `errno` set, EINVAL for a malformed header or size) on failure.
+ */
+struct trie* trie_open_mapped(const char *restrict path)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Inserts a word into a TRIE.
+ *
+ * Returns false if out of memory. The TRIE stays valid then, but the word is not counted.
+ */
+bool trie_insert(struct trie *restrict tree, const char *restrict word, size_t length)
+    __attribute__((nonnull(1, 2), warn_unused_result));
 
 struct trie_get_even_response {
     char *word;
@@ -29,10 +69,10 @@ struct trie_get_even_response {
 
 /* Gets an arbitrary word that has been inserted even (but positive) number of times. 
  *
- * Returns NULL if no such word exists. Otherwise it returns a copy of the word, so the
- * caller is responsible for freeing the memory.
+ * Stores NULL in `response->word` if no such word exists. Otherwise it stores a copy of
+ * the word, so the caller is responsible for freeing the memory. Returns false if out of memory.
  */
-struct trie_get_even_response trie_get_even(struct trie *restrict)
-    __attribute__((nonnull));
+bool trie_get_even(struct trie *restrict, struct trie_get_even_response *restrict response)
+    __attribute__((nonnull, warn_unused_result));
 
 #endif /* !_TRIE_H */
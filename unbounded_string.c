@@ -1,32 +1,55 @@
 #include "unbounded_string.h"
-#include "common.h"
 
 #include <assert.h>
+#include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+/* Strings up to this length are stored without any additional allocation */
+#define US_INLINE_CAPACITY 32
+
 struct unbounded_string {
+    /* Points either to `inline_data` or to a heap buffer */
     char *data;
     size_t capacity, length;
+
+    char inline_data[US_INLINE_CAPACITY];
 };
 
+/*
+ * =================== Private interface ===================
+ */
+
+/* Makes sure the string can hold at least `capacity` characters. Returns false if out of memory. */
+static bool reserve(struct unbounded_string *restrict us, size_t capacity)
+    __attribute__((nonnull, warn_unused_result));
+
+/*
+ * =================== Public functions ===================
+ */
+
 struct unbounded_string* us_from_string(const char *string) {
-    struct unbounded_string *result = calloc(1, sizeof(struct unbounded_string));
+    struct unbounded_string *result = malloc(sizeof(struct unbounded_string));
     if(!result)
-        fail(WITH_ERRNO, "Unable to allocate memory for an unbounded string");
+        return NULL;
 
-    result->data = strdup(string);
-    if(!result->data)
-        fail(WITH_ERRNO, "Unable to copy a string");
+    result->data = result->inline_data;
+    result->capacity = US_INLINE_CAPACITY;
+    result->length = 0;
 
-    result->capacity = result->length = strlen(string);
+    if(!us_append(result, string, strlen(string))) {
+        us_free(result);
+        return NULL;
+    }
 
     return result;
 }
 
 
 void us_free(struct unbounded_string *us) {
-    free(us->data);
+    if(us->data != us->inline_data)
+        free(us->data);
     free(us);
 }
 
@@ -34,17 +57,29 @@ const char* us_to_string(const struct unbounded_string *us) {
     return us->data;
 }
 
-void us_push(struct unbounded_string *us, char ch) {
-    if(us->capacity == us->length) {
-        us->capacity = 2 * us->capacity + 1;
-        us->data = realloc(us->data, us->capacity);
-        
-        if(!us->data)
-            fail(WITH_ERRNO, "Unable to grow an unbounded string");
-    }
+bool us_push(struct unbounded_string *us, char ch) {
+    if(us->capacity == us->length && !reserve(us, us->length + 1))
+        return false;
 
     us->data[us->length] = ch;
     us->length++;
+    return true;
+}
+
+bool us_append(struct unbounded_string *us, const char *data, size_t length) {
+    if(us->capacity - us->length < length) {
+        if(length > SIZE_MAX - us->length) {
+            errno = ENOMEM;
+            return false;
+        }
+
+        if(!reserve(us, us->length + length))
+            return false;
+    }
+
+    memcpy(us->data + us->length, data, length);
+    us->length += length;
+    return true;
 }
 
 void us_pop(struct unbounded_string *us) {
@@ -52,6 +87,62 @@ void us_pop(struct unbounded_string *us) {
     us->length--;
 }
 
+void us_clear(struct unbounded_string *us) {
+    us->length = 0;
+}
+
+void us_trim(struct unbounded_string *us, size_t high_water) {
+    size_t capacity = us->length > high_water ? us->length : high_water;
+    if(us->data == us->inline_data || us->capacity <= capacity)
+        return;
+
+    if(capacity <= US_INLINE_CAPACITY) {
+        memcpy(us->inline_data, us->data, us->length);
+        free(us->data);
+        us->data = us->inline_data;
+        us->capacity = US_INLINE_CAPACITY;
+        return;
+    }
+
+    /* Failing to shrink is harmless, the larger buffer is simply kept */
+    char *data = realloc(us->data, capacity);
+    if(!data)
+        return;
+
+    us->data = data;
+    us->capacity = capacity;
+}
+
 size_t us_length(struct unbounded_string *us) {
     return us->length;
 }
+
+/*
+ * =================== Private functions ===================
+ */
+
+bool reserve(struct unbounded_string *us, size_t capacity) {
+    if(capacity <= us->capacity)
+        return true;
+
+    if(capacity < 2 * us->capacity && us->capacity <= SIZE_MAX / 2)
+        capacity = 2 * us->capacity;
+
+    char *data;
+    if(us->data == us->inline_data) {
+        data = malloc(capacity);
+        if(!data)
+            return false;
+
+        memcpy(data, us->inline_data, us->length);
+    }
+    else {
+        data = realloc(us->data, capacity);
+        if(!data)
+            return false;
+    }
+
+    us->data = data;
+    us->capacity = capacity;
+    return true;
+}
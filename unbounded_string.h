@@ -1,14 +1,15 @@
 #ifndef _UNBOUNDED_STRING_H
 #define _UNBOUNDED_STRING_H
 
+#include <stdbool.h>
 #include <stddef.h>
 
 /* An abstract type representing an unbounded, automatically growing string */
 struct unbounded_string;
 
-/* Converts a C-string to an unbounded_string. */
+/* Converts a C-string to an unbounded_string. Returns NULL if out of memory. */
 struct unbounded_string* us_from_string(const char *restrict)
-    __attribute__((nonnull, returns_nonnull));
+    __attribute__((nonnull, warn_unused_result));
 
 /* Releases resources held by an unbounded_string. */
 void us_free(struct unbounded_string *restrict)
@@ -21,14 +22,37 @@ void us_free(struct unbounded_string *restrict)
 const char* us_to_string(const struct unbounded_string *restrict)
     __attribute__((nonnull, returns_nonnull));
 
-/* Pushes a character at the end of an unbounded_string. */
-void us_push(struct unbounded_string *restrict, char)
-    __attribute__((nonnull(1)));
+/* Pushes a character at the end of an unbounded_string.
+ *
+ * Returns false if out of memory, the string is left unchanged then.
+ */
+bool us_push(struct unbounded_string *restrict, char)
+    __attribute__((nonnull(1), warn_unused_result));
+
+/* Appends `length` characters from `data` at the end of an unbounded_string.
+ *
+ * Returns false if out of memory, the string is left unchanged then.
+ */
+bool us_append(struct unbounded_string *restrict, const char *restrict data, size_t length)
+    __attribute__((nonnull, warn_unused_result));
 
 /* Removes a character from the end of an unbounded_string. */
 void us_pop(struct unbounded_string *restrict)
     __attribute__((nonnull));
 
+/* Empties an unbounded_string, keeping its capacity. */
+void us_clear(struct unbounded_string *restrict)
+    __attribute__((nonnull));
+
+/* Shrinks the buffer of an unbounded_string to `high_water` characters (or its length, if larger).
+ *
+ * Meant to be called after an unusually long string, so that a single outlier does
+ * not pin its buffer forever, while strings up to `high_water` characters still reuse
+ * the buffer without reallocations. The contents are preserved.
+ */
+void us_trim(struct unbounded_string *restrict, size_t high_water)
+    __attribute__((nonnull));
+
 /* Returns the length of an unbounded_string. */
 size_t us_length(struct unbounded_string *restrict)
     __attribute__((nonnull, pure));
@@ -0,0 +1,398 @@
+#include "vocabulary.h"
+#include "hash.h"
+#include "unbounded_string.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The average number of words per bucket of the hash-and-displace construction */
+#define WORDS_PER_BUCKET 4
+
+/* How many displacements are tried for a single bucket before starting over */
+#define MAX_DISPLACEMENTS (1u << 20)
+
+/* How many global seeds are tried before giving up */
+#define MAX_SEEDS 16
+
+/* A slot of the perfect hash table */
+struct slot {
+    /* The low bits of the hash of the word, checked before comparing the words */
+    uint32_t fingerprint;
+    uint32_t length;
+
+    /* The offset of the word in the pool */
+    size_t offset;
+};
+
+struct vocabulary {
+    /* The number of words (and slots) and the number of buckets */
+    size_t size, bucket_count;
+
+    uint64_t seed;
+
+    /* The displacement of every bucket */
+    uint32_t *displacements;
+
+    struct slot *slots;
+
+    /* The words, every one null-terminated */
+    char *pool;
+};
+
+/* A word being added to the vocabulary */
+struct word {
+    const char *data;
+    size_t length;
+    uint64_t hash;
+    size_t bucket;
+};
+
+/* The memory used while building the perfect hash function, shared by all the seeds */
+struct scratch {
+    /* The ranges [begin, end) of words of every non-empty bucket */
+    size_t (*buckets)[2];
+
+    bool *occupied;
+    size_t *taken;
+};
+
+/*
+ * =================== Private interface ===================
+ */
+
+/* Reads the whole file into a string. Returns NULL on failure. */
+static struct unbounded_string* read_file(const char *restrict path)
+    __attribute__((nonnull));
+
+/* Splits the text into `*count` words. The caller frees `*words`. Returns false on failure. */
+static bool split_words(const char *restrict text, size_t length, struct word **restrict words, size_t *restrict count)
+    __attribute__((nonnull));
+
+/* Builds a vocabulary of `size` distinct words. Returns NULL on failure. */
+static struct vocabulary* vocabulary_create(struct word *restrict words, size_t size)
+    __attribute__((nonnull));
+
+/* Compares words bytewise, for qsort. */
+static int compare_words(const void *lhs, const void *rhs)
+    __attribute__((nonnull, pure));
+
+/* Compares words by bucket, for qsort. */
+static int compare_word_buckets(const void *lhs, const void *rhs)
+    __attribute__((nonnull, pure));
+
+/* Compares buckets by size (the larger first), for qsort. */
+static int compare_buckets(const void *lhs, const void *rhs)
+    __attribute__((nonnull, pure));
+
+/* Maps a 32-bit hash uniformly onto [0, range). */
+static inline size_t reduce(uint32_t hash, size_t range)
+    __attribute__((const));
+
+/* Returns the bucket of the word with the given hash. */
+static inline size_t bucket_of(const struct vocabulary *restrict vocabulary, uint64_t hash)
+    __attribute__((nonnull, pure));
+
+/* Returns the slot of the word with the given hash in a bucket with the given displacement. */
+static inline size_t slot_of(const struct vocabulary *restrict vocabulary, uint64_t hash, uint32_t displacement)
+    __attribute__((nonnull, pure));
+
+/* Tries to build the perfect hash function with the current seed. */
+static bool build(struct vocabulary *restrict vocabulary, struct word *restrict words, const struct scratch *restrict scratch)
+    __attribute__((nonnull));
+
+/*
+ * =================== Public functions ===================
+ */
+
+struct vocabulary* vocabulary_load(const char *path) {
+    struct unbounded_string *text = read_file(path);
+    if(!text)
+        return NULL;
+
+    struct word *words;
+    size_t count;
+    if(!split_words(us_to_string(text), us_length(text), &words, &count)) {
+        us_free(text);
+        return NULL;
+    }
+
+    /* Remove duplicates */
+    qsort(words, count, sizeof(struct word), &compare_words);
+    size_t size = 0;
+    for(size_t index = 0; index < count; ++index)
+        if(size == 0 || compare_words(&words[size - 1], &words[index]) != 0)
+            words[size++] = words[index];
+
+    struct vocabulary *vocabulary = vocabulary_create(words, size);
+
+    free(words);
+    us_free(text);
+
+    return vocabulary;
+}
+
+void vocabulary_free(struct vocabulary *vocabulary) {
+    /* Also called on partially built vocabularies */
+    free(vocabulary->pool);
+    free(vocabulary->slots);
+    free(vocabulary->displacements);
+    free(vocabulary);
+}
+
+size_t vocabulary_size(const struct vocabulary *vocabulary) {
+    return vocabulary->size;
+}
+
+size_t vocabulary_find(const struct vocabulary *vocabulary, const char *word, size_t length) {
+    if(vocabulary->size == 0)
+        return VOCABULARY_MISSING;
+
+    uint64_t hash = hash64(word, length, vocabulary->seed);
+    size_t index = slot_of(vocabulary, hash, vocabulary->displacements[bucket_of(vocabulary, hash)]);
+    const struct slot *slot = &vocabulary->slots[index];
+
+    if(slot->fingerprint != (uint32_t) hash || slot->length != length
+            || memcmp(vocabulary->pool + slot->offset, word, length) != 0)
+        return VOCABULARY_MISSING;
+
+    return index;
+}
+
+size_t vocabulary_length(const struct vocabulary *vocabulary, size_t index) {
+    return vocabulary->slots[index].length;
+}
+
+const char* vocabulary_word(const struct vocabulary *vocabulary, size_t index) {
+    return vocabulary->pool + vocabulary->slots[index].offset;
+}
+
+/*
+ * =================== Private functions ===================
+ */
+
+struct unbounded_string* read_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if(!file)
+        return NULL;
+
+    struct unbounded_string *text = us_from_string("");
+    char buffer[BUFSIZ];
+    size_t length;
+    bool ok = text != NULL;
+
+    while(ok && (length = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        ok = us_append(text, buffer, length);
+
+    if(ok && ferror(file)) {
+        errno = EIO;
+        ok = false;
+    }
+
+    fclose(file);
+    if(!ok && text) {
+        us_free(text);
+        text = NULL;
+    }
+
+    return text;
+}
+
+bool split_words(const char *text, size_t length, struct word **words, size_t *_count) {
+    size_t count = 0, capacity = 16;
+    *words = malloc(capacity * sizeof(struct word));
+    if(!*words)
+        return false;
+
+    size_t word_begin = 0;
+    for(size_t index = 0; index <= length; ++index) {
+        if(index < length && !isspace((unsigned char) text[index]))
+            continue;
+
+        if(word_begin != index) {
+            if(count == capacity) {
+                struct word *grown = realloc(*words, 2 * capacity * sizeof(struct word));
+                if(!grown) {
+                    free(*words);
+                    return false;
+                }
+
+                *words = grown;
+                capacity *= 2;
+            }
+
+            (*words)[count++] = (struct word) {
+                .data = text + word_begin,
+                .length = index - word_begin,
+            };
+        }
+        word_begin = index + 1;
+    }
+
+    if(count > UINT32_MAX) {
+        free(*words);
+        errno = EOVERFLOW;
+        return false;
+    }
+
+    *_count = count;
+    return true;
+}
+
+struct vocabulary* vocabulary_create(struct word *words, size_t size) {
+    struct vocabulary *vocabulary = calloc(1, sizeof(struct vocabulary));
+    if(!vocabulary)
+        return NULL;
+
+    vocabulary->size = size;
+    vocabulary->bucket_count = size / WORDS_PER_BUCKET + 1;
+    vocabulary->displacements = calloc(vocabulary->bucket_count, sizeof(uint32_t));
+    vocabulary->slots = calloc(size + 1, sizeof(struct slot));
+
+    struct scratch scratch = {
+        .buckets = malloc((size + 1) * sizeof(size_t[2])),
+        .occupied = malloc((size + 1) * sizeof(bool)),
+        .taken = malloc((size + 1) * sizeof(size_t)),
+    };
+
+    bool ok = vocabulary->displacements && vocabulary->slots
+        && scratch.buckets && scratch.occupied && scratch.taken;
+
+    for(vocabulary->seed = 0; ok && !build(vocabulary, words, &scratch); )
+        if(++vocabulary->seed == MAX_SEEDS) {
+            errno = EINVAL;
+            ok = false;
+        }
+
+    free(scratch.taken);
+    free(scratch.occupied);
+    free(scratch.buckets);
+
+    /* Move the words into the pool, in the slot order */
+    size_t pool_size = 0;
+    for(size_t index = 0; index < size; ++index)
+        pool_size += words[index].length + 1;
+
+    if(ok)
+        vocabulary->pool = malloc(pool_size + 1);
+
+    if(!vocabulary->pool) {
+        vocabulary_free(vocabulary);
+        return NULL;
+    }
+
+    size_t offset = 0;
+    for(size_t index = 0; index < size; ++index) {
+        const struct word *word = &words[index];
+        struct slot *slot = &vocabulary->slots[slot_of(vocabulary, word->hash, vocabulary->displacements[word->bucket])];
+
+        slot->fingerprint = word->hash;
+        slot->length = word->length;
+        slot->offset = offset;
+
+        memcpy(vocabulary->pool + offset, word->data, word->length);
+        vocabulary->pool[offset + word->length] = '\0';
+        offset += word->length + 1;
+    }
+
+    return vocabulary;
+}
+
+int compare_words(const void *_lhs, const void *_rhs) {
+    const struct word *lhs = _lhs, *rhs = _rhs;
+    size_t length = lhs->length < rhs->length ? lhs->length : rhs->length;
+
+    int r = memcmp(lhs->data, rhs->data, length);
+    if(r != 0)
+        return r;
+
+    return (lhs->length > rhs->length) - (lhs->length < rhs->length);
+}
+
+int compare_word_buckets(const void *_lhs, const void *_rhs) {
+    const struct word *lhs = _lhs, *rhs = _rhs;
+    return (lhs->bucket > rhs->bucket) - (lhs->bucket < rhs->bucket);
+}
+
+int compare_buckets(const void *_lhs, const void *_rhs) {
+    /* Buckets are given as ranges [begin, end) in the sorted array of words */
+    const size_t *lhs = _lhs, *rhs = _rhs;
+    size_t lhs_size = lhs[1] - lhs[0], rhs_size = rhs[1] - rhs[0];
+
+    return (lhs_size < rhs_size) - (lhs_size > rhs_size);
+}
+
+size_t reduce(uint32_t hash, size_t range) {
+    return ((uint64_t) hash * range) >> 32;
+}
+
+size_t bucket_of(const struct vocabulary *vocabulary, uint64_t hash) {
+    return reduce(hash >> 32, vocabulary->bucket_count);
+}
+
+size_t slot_of(const struct vocabulary *vocabulary, uint64_t hash, uint32_t displacement) {
+    return reduce(hash_mix(hash + displacement) >> 32, vocabulary->size);
+}
+
+bool build(struct vocabulary *vocabulary, struct word *words, const struct scratch *scratch) {
+    size_t size = vocabulary->size;
+
+    for(size_t index = 0; index < size; ++index) {
+        words[index].hash = hash64(words[index].data, words[index].length, vocabulary->seed);
+        words[index].bucket = bucket_of(vocabulary, words[index].hash);
+    }
+
+    qsort(words, size, sizeof(struct word), &compare_word_buckets);
+
+    size_t (*buckets)[2] = scratch->buckets;
+    bool *occupied = scratch->occupied;
+    size_t *taken = scratch->taken;
+    memset(occupied, 0, (size + 1) * sizeof(bool));
+
+    size_t bucket_count = 0;
+    for(size_t begin = 0, end; begin < size; begin = end) {
+        for(end = begin; end < size && words[end].bucket == words[begin].bucket; ++end)
+            ;
+        buckets[bucket_count][0] = begin;
+        buckets[bucket_count][1] = end;
+        ++bucket_count;
+    }
+
+    /* Place the largest buckets first, while there are still many free slots */
+    qsort(buckets, bucket_count, sizeof(size_t[2]), &compare_buckets);
+
+    bool ok = true;
+    for(size_t bucket = 0; ok && bucket < bucket_count; ++bucket) {
+        size_t begin = buckets[bucket][0], end = buckets[bucket][1];
+        uint32_t displacement;
+
+        for(displacement = 0; displacement < MAX_DISPLACEMENTS; ++displacement) {
+            size_t placed = 0;
+
+            for(size_t index = begin; index < end; ++index) {
+                size_t slot = slot_of(vocabulary, words[index].hash, displacement);
+                if(occupied[slot])
+                    break;
+
+                occupied[slot] = true;
+                taken[placed++] = slot;
+            }
+
+            if(placed == end - begin)
+                break;
+
+            while(placed > 0)
+                occupied[taken[--placed]] = false;
+        }
+
+        if(displacement == MAX_DISPLACEMENTS)
+            ok = false;
+        else
+            vocabulary->displacements[words[begin].bucket] = displacement;
+    }
+
+    return ok;
+}
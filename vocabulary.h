@@ -0,0 +1,45 @@
+#ifndef _VOCABULARY_H
+#define _VOCABULARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Returned by `vocabulary_find` for words outside of the vocabulary */
+#define VOCABULARY_MISSING SIZE_MAX
+
+/* An opaque type representing a fixed set of words.
+ *
+ * The words are numbered 0, ..., size - 1 by a minimal perfect hash function, so
+ * a lookup costs a single hash of the word, a fingerprint check and a comparison.
+ * A vocabulary is immutable and may be shared between threads.
+ */
+struct vocabulary;
+
+/* Reads a vocabulary from the file `path`, containing words separated by whitespace.
+ *
+ * Returns NULL (with `errno` set) on failure.
+ */
+struct vocabulary* vocabulary_load(const char *restrict path)
+    __attribute__((nonnull, warn_unused_result));
+
+/* Frees the resources held by a vocabulary */
+void vocabulary_free(struct vocabulary *restrict)
+    __attribute__((nonnull));
+
+/* Returns the number of distinct words in a vocabulary. */
+size_t vocabulary_size(const struct vocabulary *restrict)
+    __attribute__((nonnull, pure));
+
+/* Returns the index of the word, VOCABULARY_MISSING if it is not in the vocabulary. */
+size_t vocabulary_find(const struct vocabulary *restrict, const char *restrict word, size_t length)
+    __attribute__((nonnull, pure));
+
+/* Returns the length of the word with the given index. */
+size_t vocabulary_length(const struct vocabulary *restrict, size_t index)
+    __attribute__((nonnull, pure));
+
+/* Returns the word with the given index as a null-terminated string. */
+const char* vocabulary_word(const struct vocabulary *restrict, size_t index)
+    __attribute__((nonnull, returns_nonnull, pure));
+
+#endif /* !_VOCABULARY_H */